@@ -0,0 +1,65 @@
+#include "AccessPatternGenerator.h"
+#include "Process.h"
+#include <algorithm>
+
+static const unsigned int WORD_SIZE = 2;
+
+AccessPatternGenerator::AccessPatternGenerator(const std::string& pattern, unsigned int memorySize, unsigned int pageSize,
+    unsigned int seed)
+    : pattern(pattern), pageSize(std::max(pageSize, WORD_SIZE)), cursor(0), engine(seed) {
+    // Data accesses stay clear of the symbol table when the process has room for both
+    dataStart = memorySize > Process::SYMBOL_TABLE_SIZE + WORD_SIZE ? Process::SYMBOL_TABLE_SIZE : 0;
+    dataEnd = memorySize >= WORD_SIZE ? memorySize - memorySize % WORD_SIZE : 0;
+    cursor = dataStart;
+
+    if (pattern == "zipf" && dataEnd > dataStart) {
+        unsigned int firstPage = dataStart / this->pageSize;
+        unsigned int lastPage = (dataEnd - 1) / this->pageSize;
+        double total = 0.0;
+        for (unsigned int rank = 1; rank <= lastPage - firstPage + 1; ++rank) {
+            total += 1.0 / rank;
+            pageCdf.push_back(total);
+        }
+        for (double& p : pageCdf) {
+            p /= total;
+        }
+    }
+}
+
+unsigned int AccessPatternGenerator::randomWordIn(unsigned int begin, unsigned int end) {
+    unsigned int words = (end - begin) / WORD_SIZE;
+    if (words == 0) {
+        return begin;
+    }
+    std::uniform_int_distribution<unsigned int> word(0, words - 1);
+    return begin + word(engine) * WORD_SIZE;
+}
+
+unsigned int AccessPatternGenerator::nextAddress() {
+    if (dataEnd <= dataStart) {
+        return 0;
+    }
+
+    if (pattern == "uniform") {
+        return randomWordIn(dataStart, dataEnd);
+    }
+
+    if (pattern == "zipf") {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(engine);
+        size_t rank = std::lower_bound(pageCdf.begin(), pageCdf.end(), u) - pageCdf.begin();
+        rank = std::min(rank, pageCdf.size() - 1);
+
+        unsigned int page = dataStart / pageSize + static_cast<unsigned int>(rank);
+        unsigned int begin = std::max(page * pageSize, dataStart);
+        unsigned int end = std::min(begin - begin % pageSize + pageSize, dataEnd);
+        return randomWordIn(begin, end);
+    }
+
+    // sequential
+    unsigned int address = cursor;
+    cursor += WORD_SIZE;
+    if (cursor + WORD_SIZE > dataEnd) {
+        cursor = dataStart;
+    }
+    return address;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <random>
+#include <string>
+#include <vector>
+
+// Produces data addresses for generated READ/WRITE instructions.
+//   sequential: walks the data region word by word, wrapping at the end
+//   uniform:    any word of the data region with equal probability
+//   zipf:       pages ranked by popularity (P(k) ~ 1/k), random word within the page
+class AccessPatternGenerator {
+public:
+    // Generators with different seeds produce different address streams
+    AccessPatternGenerator(const std::string& pattern, unsigned int memorySize, unsigned int pageSize,
+        unsigned int seed);
+
+    unsigned int nextAddress();
+
+private:
+    unsigned int randomWordIn(unsigned int begin, unsigned int end);
+
+    std::string pattern;
+    unsigned int dataStart;
+    unsigned int dataEnd;
+    unsigned int pageSize;
+    unsigned int cursor;
+    // Covers the whole data region, which rand() would cap at RAND_MAX
+    std::mt19937 engine;
+
+    // Cumulative distribution over pages for zipf
+    std::vector<double> pageCdf;
+};
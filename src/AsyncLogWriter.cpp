@@ -0,0 +1,237 @@
+#include "AsyncLogWriter.h"
+#include "Config.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+static const size_t RING_CAPACITY = 1024;                          // records per core, power of two
+static const size_t MAX_OPEN_FILES = 64;
+static const size_t FLUSH_BYTES = 64 * 1024;
+static const std::chrono::milliseconds DRAIN_INTERVAL(10);
+static const std::chrono::milliseconds FLUSH_INTERVAL(100);
+
+AsyncLogWriter::CoreRing::CoreRing(size_t capacity)
+    : slots(capacity), mask(capacity - 1) {}
+
+bool AsyncLogWriter::CoreRing::tryPush(unsigned long long sequence, std::time_t timestamp, unsigned int cycle, int coreId,
+                                       int pid, const std::string& processName, const std::string& message) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == slots.size()) {
+        return false;
+    }
+
+    // Assigning into the slot reuses its string buffers once the ring has warmed up
+    LogRecord& slot = slots[t & mask];
+    slot.sequence = sequence;
+    slot.timestamp = timestamp;
+    slot.cycle = cycle;
+    slot.coreId = coreId;
+    slot.pid = pid;
+    slot.header = false;
+    slot.processName = processName;
+    slot.message = message;
+
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+void AsyncLogWriter::CoreRing::drain(std::vector<LogRecord>& out) {
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t t = tail.load(std::memory_order_acquire);
+    for (; h != t; ++h) {
+        out.push_back(slots[h & mask]);
+    }
+    head.store(h, std::memory_order_release);
+}
+
+std::atomic<const std::atomic<unsigned int>*> AsyncLogWriter::cycleSource{ nullptr };
+
+void AsyncLogWriter::setCycleSource(const std::atomic<unsigned int>* cycles) {
+    cycleSource.store(cycles);
+}
+
+unsigned int AsyncLogWriter::currentCycle() {
+    const std::atomic<unsigned int>* cycles = cycleSource.load(std::memory_order_relaxed);
+    return cycles ? cycles->load(std::memory_order_relaxed) : 0;
+}
+
+AsyncLogWriter& AsyncLogWriter::getInstance() {
+    static AsyncLogWriter instance;
+    return instance;
+}
+
+AsyncLogWriter::AsyncLogWriter()
+    : stopRequested(false), pendingBytes(0), cachedSecond(0) {
+    Config& config = Config::getInstance();
+    if (config.getLogFormat() == "binary") {
+        traceWriter.reset(new BinaryTraceWriter("csopesy-trace.bin"));
+    }
+
+    int numCores = config.getNumCpu();
+    for (int i = 0; i < numCores; ++i) {
+        rings.emplace_back(new CoreRing(RING_CAPACITY));
+    }
+    writerThread = std::thread(&AsyncLogWriter::writerLoop, this);
+}
+
+AsyncLogWriter::~AsyncLogWriter() {
+    {
+        std::lock_guard<std::mutex> lock(overflowMutex);
+        stopRequested = true;
+    }
+    wakeCV.notify_all();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+}
+
+void AsyncLogWriter::write(const std::string& processName, int pid, const std::string& message, int coreId) {
+    unsigned long long sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+    std::time_t now = std::time(nullptr);
+    unsigned int cycle = currentCycle();
+
+    if (coreId >= 0 && coreId < static_cast<int>(rings.size()) &&
+        rings[coreId]->tryPush(sequence, now, cycle, coreId, pid, processName, message)) {
+        return;
+    }
+
+    LogRecord record;
+    record.sequence = sequence;
+    record.timestamp = now;
+    record.cycle = cycle;
+    record.coreId = coreId;
+    record.pid = pid;
+    record.processName = processName;
+    record.message = message;
+
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    overflow.push_back(std::move(record));
+}
+
+void AsyncLogWriter::writeHeader(const std::string& processName, int pid) {
+    LogRecord record;
+    record.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+    record.timestamp = std::time(nullptr);
+    record.cycle = currentCycle();
+    record.pid = pid;
+    record.header = true;
+    record.processName = processName;
+
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    overflow.push_back(std::move(record));
+}
+
+void AsyncLogWriter::writerLoop() {
+    std::vector<LogRecord> batch;
+    auto lastFlush = std::chrono::steady_clock::now();
+
+    while (true) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(overflowMutex);
+            wakeCV.wait_for(lock, DRAIN_INTERVAL, [this]() { return stopRequested; });
+            stopping = stopRequested;
+            for (auto& record : overflow) {
+                batch.push_back(std::move(record));
+            }
+            overflow.clear();
+        }
+
+        for (auto& ring : rings) {
+            ring->drain(batch);
+        }
+
+        if (!batch.empty()) {
+            // Rings are drained one after another; restore the order records were produced in
+            std::sort(batch.begin(), batch.end(), [](const LogRecord& a, const LogRecord& b) {
+                return a.sequence < b.sequence;
+            });
+            for (const LogRecord& record : batch) {
+                writeRecord(record);
+            }
+            batch.clear();
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (stopping || pendingBytes >= FLUSH_BYTES || now - lastFlush >= FLUSH_INTERVAL) {
+            flushAll();
+            lastFlush = now;
+        }
+
+        if (stopping) break;
+    }
+
+    openFileIndex.clear();
+    openFiles.clear();
+}
+
+void AsyncLogWriter::writeRecord(const LogRecord& record) {
+    if (traceWriter) {
+        traceWriter->append(record.header ? TraceOpcode::Open : TraceOpcode::Log, record.cycle, record.pid,
+                            record.coreId, record.timestamp, record.header ? record.processName : record.message);
+        pendingBytes = traceWriter->getPendingBytes();
+        return;
+    }
+    writeTextRecord(record);
+}
+
+void AsyncLogWriter::writeTextRecord(const LogRecord& record) {
+    std::string fileName = record.processName + ".txt";
+    std::ofstream& logfile = openFile(fileName, record.header);
+    if (!logfile.is_open()) {
+        std::cerr << "Unable to open log file " << fileName << std::endl;
+        return;
+    }
+
+    if (record.header) {
+        logfile << "Process name: " << record.processName << "\nLogs:\n";
+        pendingBytes += record.processName.size() + 21;
+        return;
+    }
+
+    // Many records share the same second; only format the timestamp when it changes
+    if (record.timestamp != cachedSecond || cachedTimestamp.empty()) {
+        std::tm now_tm;
+        localtime_s(&now_tm, &record.timestamp);
+        std::ostringstream oss;
+        oss << "(" << std::put_time(&now_tm, "%m/%d/%Y %I:%M:%S%p") << ") ";
+        cachedTimestamp = oss.str();
+        cachedSecond = record.timestamp;
+    }
+
+    logfile << cachedTimestamp << "Core:" << record.coreId << " \"" << record.message << "\"\n";
+    pendingBytes += cachedTimestamp.size() + record.message.size() + 16;
+}
+
+std::ofstream& AsyncLogWriter::openFile(const std::string& fileName, bool truncate) {
+    auto it = openFileIndex.find(fileName);
+    if (it != openFileIndex.end()) {
+        openFiles.splice(openFiles.begin(), openFiles, it->second);
+        if (truncate) {
+            it->second->second.close();
+            it->second->second.open(fileName, std::ios::out | std::ios::trunc);
+        }
+        return it->second->second;
+    }
+
+    if (openFiles.size() >= MAX_OPEN_FILES) {
+        // Evict the least recently used file; closing it flushes its buffer
+        openFileIndex.erase(openFiles.back().first);
+        openFiles.pop_back();
+    }
+
+    openFiles.emplace_front(fileName, std::ofstream(fileName, truncate ? std::ios::out | std::ios::trunc : std::ios::app));
+    openFileIndex[fileName] = openFiles.begin();
+    return openFiles.front().second;
+}
+
+void AsyncLogWriter::flushAll() {
+    if (traceWriter) {
+        traceWriter->flush();
+    }
+    for (auto& entry : openFiles) {
+        entry.second.flush();
+    }
+    pendingBytes = 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "BinaryTrace.h"
+
+struct LogRecord {
+    unsigned long long sequence = 0;
+    std::time_t timestamp = 0;
+    unsigned int cycle = 0;
+    int coreId = -1;
+    int pid = 0;
+    bool header = false;
+    std::string processName;
+    std::string message;
+};
+
+// Moves process log file I/O off the worker threads. Each core appends to its
+// own lock-free ring; a background thread drains the rings in batches, keeps a
+// bounded set of log files open and flushes on a size or time threshold.
+// With log-format "binary" every record goes to a single trace file instead.
+class AsyncLogWriter {
+public:
+    static AsyncLogWriter& getInstance();
+
+    // Clock used to stamp records with the simulated CPU cycle
+    static void setCycleSource(const std::atomic<unsigned int>* cycles);
+
+    void write(const std::string& processName, int pid, const std::string& message, int coreId);
+    void writeHeader(const std::string& processName, int pid);
+
+    ~AsyncLogWriter();
+
+private:
+    // Single-producer (one core's worker) / single-consumer (the writer) ring
+    class CoreRing {
+    public:
+        explicit CoreRing(size_t capacity);
+        bool tryPush(unsigned long long sequence, std::time_t timestamp, unsigned int cycle, int coreId,
+                     int pid, const std::string& processName, const std::string& message);
+        void drain(std::vector<LogRecord>& out);
+
+    private:
+        std::vector<LogRecord> slots;
+        size_t mask;
+        std::atomic<size_t> head{ 0 };
+        std::atomic<size_t> tail{ 0 };
+    };
+
+    AsyncLogWriter();
+    void writerLoop();
+    void writeRecord(const LogRecord& record);
+    void writeTextRecord(const LogRecord& record);
+    std::ofstream& openFile(const std::string& fileName, bool truncate);
+    void flushAll();
+
+    static std::atomic<const std::atomic<unsigned int>*> cycleSource;
+    static unsigned int currentCycle();
+
+    std::vector<std::unique_ptr<CoreRing>> rings;
+    std::atomic<unsigned long long> nextSequence{ 0 };
+
+    // Records from threads without a core, or from a core whose ring is full
+    std::vector<LogRecord> overflow;
+    std::mutex overflowMutex;
+    std::condition_variable wakeCV;
+    bool stopRequested;
+
+    std::thread writerThread;
+
+    // Writer-thread state: binary trace, or LRU cache of open text log files
+    std::unique_ptr<BinaryTraceWriter> traceWriter;
+    std::list<std::pair<std::string, std::ofstream>> openFiles;
+    std::unordered_map<std::string, std::list<std::pair<std::string, std::ofstream>>::iterator> openFileIndex;
+    size_t pendingBytes;
+    std::time_t cachedSecond;
+    std::string cachedTimestamp;
+};
@@ -0,0 +1,134 @@
+#include "BackingStore.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+BackingStore::BackingStore()
+    : slotSize(0), numSlots(0), nextUntouchedSlot(0), usedSlots(0), numReads(0), numWrites(0), bytesRead(0), bytesWritten(0) {}
+
+BackingStore::~BackingStore() {
+    close();
+}
+
+bool BackingStore::open(const std::string& path, unsigned int slotSize, unsigned int numSlots) {
+    close();
+
+    this->path = path;
+    this->slotSize = slotSize;
+    this->numSlots = numSlots;
+    usedSlots = 0;
+    numReads = numWrites = bytesRead = bytesWritten = 0;
+
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Failed to create backing store " << path << std::endl;
+        this->numSlots = 0;
+        freeSlots.clear();
+        nextUntouchedSlot = 0;
+        return false;
+    }
+
+    // The file grows as slots are first written, so a large swap area costs
+    // nothing until it is used
+    freeSlots.clear();
+    nextUntouchedSlot = 0;
+    return true;
+}
+
+void BackingStore::close() {
+    if (file.is_open()) {
+        file.close();
+        std::remove(path.c_str());
+    }
+}
+
+int BackingStore::allocateSlot() {
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else if (nextUntouchedSlot < numSlots) {
+        slot = static_cast<int>(nextUntouchedSlot++);
+    }
+    else {
+        return -1;
+    }
+    usedSlots++;
+    return slot;
+}
+
+void BackingStore::freeSlot(int slot) {
+    if (slot >= 0 && static_cast<unsigned int>(slot) < nextUntouchedSlot) {
+        freeSlots.push_back(slot);
+        usedSlots--;
+    }
+}
+
+bool BackingStore::hasFreeSlot() const {
+    return !freeSlots.empty() || nextUntouchedSlot < numSlots;
+}
+
+bool BackingStore::writeSlot(int slot, const std::vector<char>& data) {
+    if (!file.is_open() || slot < 0 || static_cast<unsigned int>(slot) >= numSlots || data.size() > slotSize) {
+        return false;
+    }
+    file.seekp(static_cast<std::streamoff>(slot) * slotSize);
+    file.write(data.data(), data.size());
+    if (!file) {
+        file.clear();
+        return false;
+    }
+    numWrites++;
+    bytesWritten += data.size();
+    return true;
+}
+
+bool BackingStore::readSlot(int slot, std::vector<char>& data) {
+    if (!file.is_open() || slot < 0 || static_cast<unsigned int>(slot) >= numSlots) {
+        return false;
+    }
+    data.resize(slotSize);
+    file.seekg(static_cast<std::streamoff>(slot) * slotSize);
+    file.read(data.data(), slotSize);
+    if (!file) {
+        // A partly written slot at the end of the file reads short
+        std::streamsize bytes = file.gcount();
+        file.clear();
+        if (bytes <= 0) {
+            return false;
+        }
+        std::fill(data.begin() + bytes, data.end(), 0);
+    }
+    numReads++;
+    bytesRead += slotSize;
+    return true;
+}
+
+unsigned int BackingStore::getSlotSize() const {
+    return slotSize;
+}
+
+unsigned int BackingStore::getNumSlots() const {
+    return numSlots;
+}
+
+unsigned int BackingStore::getUsedSlots() const {
+    return usedSlots;
+}
+
+uint64_t BackingStore::getNumReads() const {
+    return numReads;
+}
+
+uint64_t BackingStore::getNumWrites() const {
+    return numWrites;
+}
+
+uint64_t BackingStore::getBytesRead() const {
+    return bytesRead;
+}
+
+uint64_t BackingStore::getBytesWritten() const {
+    return bytesWritten;
+}
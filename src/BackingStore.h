@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Single swap file split into fixed-size slots. Callers
+// serialize slot and file access; the counters are atomic so statistics can
+// be read without that lock.
+class BackingStore {
+public:
+    BackingStore();
+    ~BackingStore();
+
+    bool open(const std::string& path, unsigned int slotSize, unsigned int numSlots);
+    void close();
+
+    // Returns -1 when every slot is in use
+    int allocateSlot();
+    void freeSlot(int slot);
+    bool hasFreeSlot() const;
+
+    bool writeSlot(int slot, const std::vector<char>& data);
+    bool readSlot(int slot, std::vector<char>& data);
+
+    unsigned int getSlotSize() const;
+    unsigned int getNumSlots() const;
+    unsigned int getUsedSlots() const;
+
+    uint64_t getNumReads() const;
+    uint64_t getNumWrites() const;
+    uint64_t getBytesRead() const;
+    uint64_t getBytesWritten() const;
+
+private:
+    std::fstream file;
+    std::string path;
+    unsigned int slotSize;
+    unsigned int numSlots;
+    // Slots freed after use; slots from nextUntouchedSlot on were never handed out
+    std::vector<int> freeSlots;
+    unsigned int nextUntouchedSlot;
+    std::atomic<unsigned int> usedSlots;
+
+    std::atomic<uint64_t> numReads;
+    std::atomic<uint64_t> numWrites;
+    std::atomic<uint64_t> bytesRead;
+    std::atomic<uint64_t> bytesWritten;
+};
@@ -0,0 +1,188 @@
+#include "BinaryTrace.h"
+#include <cctype>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+static const char TRACE_MAGIC[4] = { 'C', 'S', 'T', 'R' };
+
+BinaryTraceWriter::BinaryTraceWriter(const std::string& fileName)
+    : file(fileName, std::ios::binary | std::ios::out | std::ios::trunc), pendingBytes(0), lastSecond(0) {
+    if (!file.is_open()) {
+        std::cerr << "Unable to open trace file " << fileName << std::endl;
+    }
+}
+
+uint32_t BinaryTraceWriter::intern(const std::string& text) {
+    auto it = stringIds.find(text);
+    if (it != stringIds.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(stringIds.size());
+    stringIds[text] = id;
+    newStrings.emplace_back(id, text);
+    pendingBytes += 2 * sizeof(uint32_t) + text.size();
+    return id;
+}
+
+void BinaryTraceWriter::append(TraceOpcode opcode, unsigned int cycle, int pid, int coreId,
+                               std::time_t timestamp, const std::string& text) {
+    if (timestamp != lastSecond) {
+        records.push_back({ cycle, 0, 0, static_cast<uint32_t>(timestamp), -1, static_cast<uint16_t>(TraceOpcode::Time) });
+        lastSecond = timestamp;
+    }
+
+    // Generated messages usually end in a counter ("... Instruction 42"); keep the
+    // prefix in the string table and the number in the record so it interns well
+    uint32_t argument = TRACE_NO_ARGUMENT;
+    size_t digits = 0;
+    while (digits < text.size() && digits < 9 && isdigit(static_cast<unsigned char>(text[text.size() - 1 - digits]))) {
+        digits++;
+    }
+    std::string prefix = text;
+    if (opcode == TraceOpcode::Log && digits > 0 && (digits == 1 || text[text.size() - digits] != '0') &&
+        (digits == text.size() || !isdigit(static_cast<unsigned char>(text[text.size() - digits - 1])))) {
+        argument = static_cast<uint32_t>(std::stoul(text.substr(text.size() - digits)));
+        prefix = text.substr(0, text.size() - digits);
+    }
+
+    records.push_back({ cycle, static_cast<uint32_t>(pid), intern(prefix), argument,
+                        static_cast<int16_t>(coreId), static_cast<uint16_t>(opcode) });
+    pendingBytes += sizeof(TraceRecord);
+}
+
+size_t BinaryTraceWriter::getPendingBytes() const {
+    return pendingBytes;
+}
+
+void BinaryTraceWriter::flush() {
+    if (records.empty() && newStrings.empty()) {
+        return;
+    }
+
+    TraceSegmentHeader header;
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.stringCount = static_cast<uint32_t>(newStrings.size());
+    header.recordCount = static_cast<uint32_t>(records.size());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const auto& entry : newStrings) {
+        uint32_t length = static_cast<uint32_t>(entry.second.size());
+        file.write(reinterpret_cast<const char*>(&entry.first), sizeof(entry.first));
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(entry.second.data(), length);
+    }
+    file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(TraceRecord));
+    file.flush();
+
+    newStrings.clear();
+    records.clear();
+    pendingBytes = 0;
+}
+
+bool BinaryTraceDecoder::decode(const std::string& fileName, const std::string& processFilter,
+                                int coreFilter, std::ostream& out) {
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open trace file " << fileName << std::endl;
+        return false;
+    }
+    // Lengths and counts are checked against what is left before anything is allocated
+    file.seekg(0, std::ios::end);
+    std::streamoff fileSize = file.tellg();
+    file.seekg(0, std::ios::beg);
+    auto remaining = [&]() { return static_cast<uint64_t>(fileSize - file.tellg()); };
+
+    std::vector<std::string> strings;
+    std::unordered_map<uint32_t, std::string> processNames;
+    std::time_t currentSecond = 0;
+    std::string timestamp;
+
+    TraceSegmentHeader header;
+    while (file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        if (std::memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 || header.version != TRACE_VERSION) {
+            std::cerr << "Corrupt or unsupported trace segment in " << fileName << std::endl;
+            return false;
+        }
+
+        // Ids are handed out in order, so a segment only adds to the end of the table
+        uint64_t maxStrings = static_cast<uint64_t>(strings.size()) + header.stringCount;
+        for (uint32_t i = 0; i < header.stringCount; ++i) {
+            uint32_t id = 0;
+            uint32_t length = 0;
+            file.read(reinterpret_cast<char*>(&id), sizeof(id));
+            file.read(reinterpret_cast<char*>(&length), sizeof(length));
+            if (!file || length > remaining()) {
+                std::cerr << "Truncated trace segment in " << fileName << std::endl;
+                return false;
+            }
+            if (id >= maxStrings) {
+                std::cerr << "Corrupt string table in " << fileName << std::endl;
+                return false;
+            }
+            std::string text(length, '\0');
+            file.read(&text[0], length);
+            if (!file) {
+                std::cerr << "Truncated trace segment in " << fileName << std::endl;
+                return false;
+            }
+            if (id >= strings.size()) {
+                strings.resize(id + 1);
+            }
+            strings[id] = text;
+        }
+
+        if (static_cast<uint64_t>(header.recordCount) * sizeof(TraceRecord) > remaining()) {
+            std::cerr << "Truncated trace segment in " << fileName << std::endl;
+            return false;
+        }
+        std::vector<TraceRecord> records(header.recordCount);
+        file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(TraceRecord));
+        if (!file) {
+            std::cerr << "Truncated trace segment in " << fileName << std::endl;
+            return false;
+        }
+
+        for (const TraceRecord& record : records) {
+            TraceOpcode opcode = static_cast<TraceOpcode>(record.opcode);
+            if (opcode == TraceOpcode::Time) {
+                currentSecond = static_cast<std::time_t>(record.argument);
+                std::tm now_tm;
+                localtime_s(&now_tm, &currentSecond);
+                std::ostringstream oss;
+                oss << "(" << std::put_time(&now_tm, "%m/%d/%Y %I:%M:%S%p") << ") ";
+                timestamp = oss.str();
+                continue;
+            }
+            if (record.stringId >= strings.size()) {
+                std::cerr << "Trace record refers to unknown string " << record.stringId << " in " << fileName << std::endl;
+                return false;
+            }
+
+            if (opcode == TraceOpcode::Open) {
+                processNames[record.pid] = strings[record.stringId];
+                // Only a single-process view reproduces the per-process file header
+                if (!processFilter.empty() && processFilter == strings[record.stringId]) {
+                    out << "Process name: " << strings[record.stringId] << "\nLogs:\n";
+                }
+                continue;
+            }
+
+            const std::string& processName = processNames[record.pid];
+            if (!processFilter.empty() && processFilter != processName) continue;
+            if (coreFilter >= 0 && coreFilter != record.coreId) continue;
+
+            if (processFilter.empty()) {
+                out << "[" << processName << "] ";
+            }
+            out << timestamp << "Core:" << record.coreId << " \"" << strings[record.stringId];
+            if (record.argument != TRACE_NO_ARGUMENT) {
+                out << record.argument;
+            }
+            out << "\"\n";
+        }
+    }
+    return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compact binary alternative to the per-process text logs. The trace is one
+// file made of segments; each segment holds the strings first used in it
+// followed by fixed-size records that refer to them by id.
+
+enum class TraceOpcode : uint16_t {
+    Open = 0,   // process log started; stringId is the process name
+    Log = 1,    // process log line; stringId (+ numeric argument) is the message
+    Time = 2    // wall clock moved to a new second; argument is the time_t value
+};
+
+const uint32_t TRACE_NO_ARGUMENT = 0xFFFFFFFF;
+const uint32_t TRACE_VERSION = 1;
+
+struct TraceRecord {
+    uint32_t cycle;
+    uint32_t pid;
+    uint32_t stringId;
+    uint32_t argument;
+    int16_t coreId;
+    uint16_t opcode;
+};
+static_assert(sizeof(TraceRecord) == 20, "TraceRecord must stay fixed-size");
+
+struct TraceSegmentHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t stringCount;
+    uint32_t recordCount;
+};
+
+class BinaryTraceWriter {
+public:
+    explicit BinaryTraceWriter(const std::string& fileName);
+
+    void append(TraceOpcode opcode, unsigned int cycle, int pid, int coreId,
+                std::time_t timestamp, const std::string& text);
+    size_t getPendingBytes() const;
+    void flush();
+
+private:
+    uint32_t intern(const std::string& text);
+
+    std::ofstream file;
+    std::unordered_map<std::string, uint32_t> stringIds;
+
+    // Contents of the segment being built
+    std::vector<std::pair<uint32_t, std::string>> newStrings;
+    std::vector<TraceRecord> records;
+    size_t pendingBytes;
+
+    std::time_t lastSecond;
+};
+
+class BinaryTraceDecoder {
+public:
+    // Renders the trace in the text log format. An empty processFilter and a
+    // negative coreFilter select everything.
+    static bool decode(const std::string& fileName, const std::string& processFilter,
+                       int coreFilter, std::ostream& out);
+};
@@ -0,0 +1,156 @@
+#include "BuddyAllocator.h"
+#include <algorithm>
+
+BuddyAllocator::BuddyAllocator()
+    : capacity(0), minBlockSize(1), maxOrder(0), used(0), requested(0) {}
+
+void BuddyAllocator::initialize(size_t capacity, size_t minBlockSize) {
+    this->minBlockSize = std::max<size_t>(minBlockSize, 1);
+    // The managed region is the largest power-of-two multiple of the minimum block
+    maxOrder = 0;
+    while ((this->minBlockSize << (maxOrder + 1)) <= capacity) {
+        maxOrder++;
+    }
+    this->capacity = capacity >= this->minBlockSize ? blockSize(maxOrder) : 0;
+
+    used = 0;
+    requested = 0;
+    allocations.clear();
+    allocatedByOffset.clear();
+    freeLists.assign(maxOrder + 1, std::set<size_t>());
+    if (this->capacity > 0) {
+        freeLists[maxOrder].insert(0);
+    }
+}
+
+size_t BuddyAllocator::blockSize(unsigned int order) const {
+    return minBlockSize << order;
+}
+
+unsigned int BuddyAllocator::orderFor(size_t size) const {
+    unsigned int order = 0;
+    while (blockSize(order) < size) {
+        order++;
+    }
+    return order;
+}
+
+bool BuddyAllocator::allocate(Process* owner, size_t size) {
+    if (size == 0 || size > capacity || allocations.count(owner) > 0) {
+        return false;
+    }
+
+    unsigned int order = orderFor(size);
+    unsigned int available = order;
+    while (available <= maxOrder && freeLists[available].empty()) {
+        available++;
+    }
+    if (available > maxOrder) {
+        return false;
+    }
+
+    size_t offset = *freeLists[available].begin();
+    freeLists[available].erase(freeLists[available].begin());
+
+    // Split down to the requested order, returning each upper half to its list
+    while (available > order) {
+        available--;
+        freeLists[available].insert(offset + blockSize(available));
+    }
+
+    allocations[owner] = { offset, order, size };
+    allocatedByOffset[offset] = owner;
+    used += blockSize(order);
+    requested += size;
+    return true;
+}
+
+size_t BuddyAllocator::release(Process* owner) {
+    auto it = allocations.find(owner);
+    if (it == allocations.end()) {
+        return 0;
+    }
+
+    size_t offset = it->second.offset;
+    unsigned int order = it->second.order;
+    size_t released = blockSize(order);
+    used -= released;
+    requested -= it->second.requested;
+    allocatedByOffset.erase(offset);
+    allocations.erase(it);
+
+    // Merge with the buddy for as long as it is free
+    while (order < maxOrder) {
+        size_t buddy = offset ^ blockSize(order);
+        auto buddyIt = freeLists[order].find(buddy);
+        if (buddyIt == freeLists[order].end()) {
+            break;
+        }
+        freeLists[order].erase(buddyIt);
+        offset = std::min(offset, buddy);
+        order++;
+    }
+    freeLists[order].insert(offset);
+    return released;
+}
+
+bool BuddyAllocator::contains(Process* owner) const {
+    return allocations.count(owner) > 0;
+}
+
+std::vector<std::pair<Process*, size_t>> BuddyAllocator::getAllocations() const {
+    std::vector<std::pair<Process*, size_t>> result;
+    for (const auto& entry : allocatedByOffset) {
+        result.emplace_back(entry.second, blockSize(allocations.at(entry.second).order));
+    }
+    return result;
+}
+
+std::vector<BlockInfo> BuddyAllocator::getBlocks() const {
+    std::vector<BlockInfo> result;
+    for (const auto& entry : allocatedByOffset) {
+        result.push_back({ entry.first, blockSize(allocations.at(entry.second).order), entry.second });
+    }
+    for (unsigned int order = 0; order <= maxOrder; ++order) {
+        for (size_t offset : freeLists[order]) {
+            result.push_back({ offset, blockSize(order), nullptr });
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const BlockInfo& a, const BlockInfo& b) {
+        return a.offset < b.offset;
+    });
+    return result;
+}
+
+size_t BuddyAllocator::getCapacity() const {
+    return capacity;
+}
+
+size_t BuddyAllocator::getUsed() const {
+    return used;
+}
+
+FragmentationStats BuddyAllocator::getFragmentationStats() const {
+    FragmentationStats stats;
+    stats.freeBytes = capacity - used;
+    stats.allocatedBlocks = allocations.size();
+    stats.freeBlocks = 0;
+    stats.largestFreeBlock = 0;
+    for (unsigned int order = 0; order <= maxOrder; ++order) {
+        stats.freeBlocks += freeLists[order].size();
+        if (!freeLists[order].empty()) {
+            stats.largestFreeBlock = blockSize(order);
+        }
+    }
+    stats.externalFragmentation = stats.freeBytes > 0
+        ? (1.0 - static_cast<double>(stats.largestFreeBlock) / stats.freeBytes) * 100.0
+        : 0.0;
+    stats.internalFragmentation = used > 0
+        ? (1.0 - static_cast<double>(requested) / used) * 100.0
+        : 0.0;
+    return stats;
+}
+
+std::string BuddyAllocator::getName() const {
+    return "buddy";
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ContiguousAllocator.h"
+#include <map>
+#include <set>
+#include <unordered_map>
+
+// Binary buddy system over a power-of-two region. Requests are rounded up to
+// a power-of-two block of at least minBlockSize; free blocks live in one
+// address-ordered list per order, so split and coalesce are O(log n).
+class BuddyAllocator : public ContiguousAllocator {
+public:
+    BuddyAllocator();
+
+    void initialize(size_t capacity, size_t minBlockSize);
+
+    bool allocate(Process* owner, size_t size) override;
+    size_t release(Process* owner) override;
+    bool contains(Process* owner) const override;
+
+    std::vector<std::pair<Process*, size_t>> getAllocations() const override;
+    std::vector<BlockInfo> getBlocks() const override;
+
+    size_t getCapacity() const override;
+    size_t getUsed() const override;
+    FragmentationStats getFragmentationStats() const override;
+    std::string getName() const override;
+
+private:
+    struct Allocation {
+        size_t offset;
+        unsigned int order;
+        size_t requested;
+    };
+
+    size_t blockSize(unsigned int order) const;
+    unsigned int orderFor(size_t size) const;
+
+    size_t capacity;
+    size_t minBlockSize;
+    unsigned int maxOrder;
+    size_t used;
+    size_t requested;
+
+    std::vector<std::set<size_t>> freeLists;
+    std::unordered_map<Process*, Allocation> allocations;
+    // Allocated block offsets in address order, for the memory map
+    std::map<size_t, Process*> allocatedByOffset;
+};
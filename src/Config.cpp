@@ -1,5 +1,6 @@
 #include "Config.h"
 #include "ConfigUtils.h"
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -20,7 +21,30 @@ Config::Config()
     maxOverallMem(512),
     memPerFrame(256),
     minMemPerProc(512),
-    maxMemPerProc(512) {
+    maxMemPerProc(512),
+    logFormat("text"),
+    pageReplacement("fifo"),
+    accessPattern("sequential"),
+    memAccessPercent(50),
+    allocationPolicy("first-fit"),
+    memoryMode("auto"),
+    compactionThreshold(25),
+    swapVictimPolicy("lru"),
+    tlbEntries(16),
+    tlbAssociativity(4),
+    tlbReplacement("lru"),
+    tlbContextSwitch("asid"),
+    pageTableLevels(0),
+    hugePageRatio(1),
+    hugePageMinMem(0),
+    forkPercent(0),
+    sharedSegmentSize(0),
+    sharedSegments(1),
+    swapIoThreads(0),
+    swapLatency(0),
+    swapBandwidth(0),
+    memmapInterval(0),
+    workingSetWindow(0) {
 }
 
 bool Config::loadConfig(const std::string& filename) {
@@ -84,11 +108,14 @@ bool Config::loadConfig(const std::string& filename) {
             }
         }
         else if (paramName == "delay-per-exec") {
-            iss >> delaysPerExec;
-            if (delaysPerExec < 0) {
+            // Read signed, since a negative value would wrap into the unsigned field
+            long long delay = -1;
+            iss >> delay;
+            if (delay < 0 || delay > UINT32_MAX) {
                 std::cerr << "Invalid delays-per-exec in " << filename << ": must be non-negative" << std::endl;
                 return false;
             }
+            delaysPerExec = static_cast<unsigned int>(delay);
         }
         else if (paramName == "max-overall-mem") {
             iss >> maxOverallMem;
@@ -126,6 +153,184 @@ bool Config::loadConfig(const std::string& filename) {
                 return false;
             }
         }
+        else if (paramName == "log-format") {
+            std::string formatValue;
+            iss >> formatValue;
+            logFormat = ConfigUtils::stripQuotes(formatValue);
+            if (logFormat != "text" && logFormat != "binary") {
+                std::cerr << "Invalid log-format in " << filename << ": must be 'text' or 'binary'" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "page-replacement") {
+            std::string policyValue;
+            iss >> policyValue;
+            pageReplacement = ConfigUtils::stripQuotes(policyValue);
+            if (pageReplacement != "fifo" && pageReplacement != "lru" &&
+                pageReplacement != "clock" && pageReplacement != "second-chance") {
+                std::cerr << "Invalid page-replacement in " << filename << ": must be 'fifo', 'lru', 'clock' or 'second-chance'" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "access-pattern") {
+            std::string patternValue;
+            iss >> patternValue;
+            accessPattern = ConfigUtils::stripQuotes(patternValue);
+            if (accessPattern != "sequential" && accessPattern != "uniform" && accessPattern != "zipf") {
+                std::cerr << "Invalid access-pattern in " << filename << ": must be 'sequential', 'uniform' or 'zipf'" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "mem-access-percent") {
+            iss >> memAccessPercent;
+            if (memAccessPercent > 100) {
+                std::cerr << "Invalid mem-access-percent in " << filename << ": must be between 0 and 100" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "allocation-policy") {
+            std::string policyValue;
+            iss >> policyValue;
+            allocationPolicy = ConfigUtils::stripQuotes(policyValue);
+            if (allocationPolicy != "first-fit" && allocationPolicy != "best-fit" &&
+                allocationPolicy != "worst-fit" && allocationPolicy != "next-fit") {
+                std::cerr << "Invalid allocation-policy in " << filename << ": must be 'first-fit', 'best-fit', 'worst-fit' or 'next-fit'" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "memory-mode") {
+            std::string modeValue;
+            iss >> modeValue;
+            memoryMode = ConfigUtils::stripQuotes(modeValue);
+            if (memoryMode != "auto" && memoryMode != "flat" && memoryMode != "paging" && memoryMode != "buddy") {
+                std::cerr << "Invalid memory-mode in " << filename << ": must be 'auto', 'flat', 'paging' or 'buddy'" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "compaction-threshold") {
+            iss >> compactionThreshold;
+            if (compactionThreshold > 100) {
+                std::cerr << "Invalid compaction-threshold in " << filename << ": must be between 0 and 100" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "swap-victim-policy") {
+            std::string policyValue;
+            iss >> policyValue;
+            swapVictimPolicy = ConfigUtils::stripQuotes(policyValue);
+            if (swapVictimPolicy != "fifo" && swapVictimPolicy != "lru" && swapVictimPolicy != "smallest-fit") {
+                std::cerr << "Invalid swap-victim-policy in " << filename << ": must be 'fifo', 'lru' or 'smallest-fit'" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "tlb-entries") {
+            iss >> tlbEntries;
+            if (tlbEntries > 4096 || (tlbEntries != 0 && !ConfigUtils::isPowerOfTwo(tlbEntries))) {
+                std::cerr << "Invalid tlb-entries in " << filename << ": must be 0 or a power of 2 up to 4096" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "tlb-associativity") {
+            iss >> tlbAssociativity;
+            if (!ConfigUtils::isPowerOfTwo(tlbAssociativity) || (tlbEntries != 0 && tlbAssociativity > tlbEntries)) {
+                std::cerr << "Invalid tlb-associativity in " << filename << ": must be a power of 2 no greater than tlb-entries" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "tlb-replacement") {
+            std::string policyValue;
+            iss >> policyValue;
+            tlbReplacement = ConfigUtils::stripQuotes(policyValue);
+            if (tlbReplacement != "lru" && tlbReplacement != "fifo" && tlbReplacement != "random") {
+                std::cerr << "Invalid tlb-replacement in " << filename << ": must be 'lru', 'fifo' or 'random'" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "tlb-context-switch") {
+            std::string switchValue;
+            iss >> switchValue;
+            tlbContextSwitch = ConfigUtils::stripQuotes(switchValue);
+            if (tlbContextSwitch != "flush" && tlbContextSwitch != "asid") {
+                std::cerr << "Invalid tlb-context-switch in " << filename << ": must be 'flush' or 'asid'" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "page-table-levels") {
+            iss >> pageTableLevels;
+            if (pageTableLevels > 3) {
+                std::cerr << "Invalid page-table-levels in " << filename << ": must be 0 (by size), 1, 2 or 3" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "huge-page-ratio") {
+            iss >> hugePageRatio;
+            if (!ConfigUtils::isPowerOfTwo(hugePageRatio) || hugePageRatio > 512) {
+                std::cerr << "Invalid huge-page-ratio in " << filename << ": must be a power of 2 up to 512 (1 disables huge pages)" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "huge-page-min-mem") {
+            iss >> hugePageMinMem;
+            if (hugePageMinMem > maxOverallMem) {
+                std::cerr << "Invalid huge-page-min-mem in " << filename << ": must be between 0 and max-overall-mem" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "fork-percent") {
+            iss >> forkPercent;
+            if (forkPercent > 100) {
+                std::cerr << "Invalid fork-percent in " << filename << ": must be between 0 and 100" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "shared-segment-size") {
+            iss >> sharedSegmentSize;
+            // Segments are whole pages at the top of each process; page 0 stays private
+            unsigned int segmentPages = (sharedSegmentSize + memPerFrame - 1) / memPerFrame;
+            if (sharedSegmentSize > 0 && static_cast<uint64_t>(segmentPages + 1) * memPerFrame > minMemPerProc) {
+                std::cerr << "Invalid shared-segment-size in " << filename << ": must leave at least one page of min-mem-per-proc private" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "shared-segments") {
+            iss >> sharedSegments;
+            if (sharedSegments < 1) {
+                std::cerr << "Invalid shared-segments in " << filename << ": must be at least 1" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "swap-io-threads") {
+            iss >> swapIoThreads;
+            if (swapIoThreads > 64) {
+                std::cerr << "Invalid swap-io-threads in " << filename << ": must be between 0 and 64" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "swap-latency") {
+            iss >> swapLatency;
+            // In microseconds; a synchronous swap stalls memory management this long
+            if (iss.fail() || swapLatency > 1000000) {
+                std::cerr << "Invalid swap-latency in " << filename << ": must be between 0 and 1000000" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "swap-bandwidth") {
+            iss >> swapBandwidth;
+            if (iss.fail() || swapBandwidth > 1000000) {
+                std::cerr << "Invalid swap-bandwidth in " << filename << ": must be between 0 (unlimited) and 1000000" << std::endl;
+                return false;
+            }
+        }
+        else if (paramName == "memmap-interval") {
+            iss >> memmapInterval;
+        }
+        else if (paramName == "working-set-window") {
+            iss >> workingSetWindow;
+            if (workingSetWindow > 1000000) {
+                std::cerr << "Invalid working-set-window in " << filename << ": must be between 0 and 1000000" << std::endl;
+                return false;
+            }
+        }
         else {
             std::cerr << "Unknown parameter in " << filename << ": " << paramName << std::endl;
             return false;
@@ -178,4 +383,96 @@ unsigned int Config::getMinMemPerProc() const {
 
 unsigned int Config::getMaxMemPerProc() const {
     return maxMemPerProc;
+}
+
+const std::string& Config::getLogFormat() const {
+    return logFormat;
+}
+
+const std::string& Config::getPageReplacement() const {
+    return pageReplacement;
+}
+
+const std::string& Config::getAccessPattern() const {
+    return accessPattern;
+}
+
+unsigned int Config::getMemAccessPercent() const {
+    return memAccessPercent;
+}
+
+const std::string& Config::getAllocationPolicy() const {
+    return allocationPolicy;
+}
+
+const std::string& Config::getMemoryMode() const {
+    return memoryMode;
+}
+
+unsigned int Config::getCompactionThreshold() const {
+    return compactionThreshold;
+}
+
+const std::string& Config::getSwapVictimPolicy() const {
+    return swapVictimPolicy;
+}
+
+unsigned int Config::getTlbEntries() const {
+    return tlbEntries;
+}
+
+unsigned int Config::getTlbAssociativity() const {
+    return tlbAssociativity;
+}
+
+const std::string& Config::getTlbReplacement() const {
+    return tlbReplacement;
+}
+
+const std::string& Config::getTlbContextSwitch() const {
+    return tlbContextSwitch;
+}
+
+unsigned int Config::getPageTableLevels() const {
+    return pageTableLevels;
+}
+
+unsigned int Config::getHugePageRatio() const {
+    return hugePageRatio;
+}
+
+unsigned int Config::getHugePageMinMem() const {
+    return hugePageMinMem;
+}
+
+unsigned int Config::getForkPercent() const {
+    return forkPercent;
+}
+
+unsigned int Config::getSharedSegmentSize() const {
+    return sharedSegmentSize;
+}
+
+unsigned int Config::getSharedSegments() const {
+    return sharedSegments;
+}
+
+unsigned int Config::getSwapIoThreads() const {
+    return swapIoThreads;
+}
+
+unsigned int Config::getSwapLatency() const {
+    return swapLatency;
+}
+
+unsigned int Config::getSwapBandwidth() const {
+    return swapBandwidth;
+}
+
+unsigned int Config::getMemmapInterval() const {
+    return memmapInterval;
+}
+
+unsigned int Config::getWorkingSetWindow() const {
+    return workingSetWindow;
 }
\ No newline at end of file
@@ -25,6 +25,29 @@ public:
     unsigned int getMemPerFrame() const;
     unsigned int getMinMemPerProc() const;
     unsigned int getMaxMemPerProc() const;
+    const std::string& getLogFormat() const;
+    const std::string& getPageReplacement() const;
+    const std::string& getAccessPattern() const;
+    unsigned int getMemAccessPercent() const;
+    const std::string& getAllocationPolicy() const;
+    const std::string& getMemoryMode() const;
+    unsigned int getCompactionThreshold() const;
+    const std::string& getSwapVictimPolicy() const;
+    unsigned int getTlbEntries() const;
+    unsigned int getTlbAssociativity() const;
+    const std::string& getTlbReplacement() const;
+    const std::string& getTlbContextSwitch() const;
+    unsigned int getPageTableLevels() const;
+    unsigned int getHugePageRatio() const;
+    unsigned int getHugePageMinMem() const;
+    unsigned int getForkPercent() const;
+    unsigned int getSharedSegmentSize() const;
+    unsigned int getSharedSegments() const;
+    unsigned int getSwapIoThreads() const;
+    unsigned int getSwapLatency() const;
+    unsigned int getSwapBandwidth() const;
+    unsigned int getMemmapInterval() const;
+    unsigned int getWorkingSetWindow() const;
 
 private:
     Config();
@@ -39,4 +62,27 @@ private:
     unsigned int memPerFrame;
     unsigned int minMemPerProc;
     unsigned int maxMemPerProc;
+    std::string logFormat;
+    std::string pageReplacement;
+    std::string accessPattern;
+    unsigned int memAccessPercent;
+    std::string allocationPolicy;
+    std::string memoryMode;
+    unsigned int compactionThreshold;
+    std::string swapVictimPolicy;
+    unsigned int tlbEntries;
+    unsigned int tlbAssociativity;
+    std::string tlbReplacement;
+    std::string tlbContextSwitch;
+    unsigned int pageTableLevels;
+    unsigned int hugePageRatio;
+    unsigned int hugePageMinMem;
+    unsigned int forkPercent;
+    unsigned int sharedSegmentSize;
+    unsigned int sharedSegments;
+    unsigned int swapIoThreads;
+    unsigned int swapLatency;
+    unsigned int swapBandwidth;
+    unsigned int memmapInterval;
+    unsigned int workingSetWindow;
 };
\ No newline at end of file
@@ -1,28 +1,42 @@
 #include "ConsoleManager.h"
+#include "AsyncLogWriter.h"
 #include "MainConsole.h"
+#include "AccessPatternGenerator.h"
+#include "DeclareCommand.h"
+#include "ForkCommand.h"
 #include "PrintCommand.h"
+#include "ReadCommand.h"
 #include "SchedulerFactory.h"
 #include "SchedulerFirstComeFirstServe.h"
 #include "SchedulerRoundRobin.h"
 #include "Screen.h"
+#include "WriteCommand.h"
 #include <chrono>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <thread>
 
+static const unsigned int RETIRE_INTERVAL_CYCLES = 100;
+const char* const ConsoleManager::MEMMAP_FILE = "csopesy-memmap.txt";
+
 ConsoleManager::ConsoleManager()
-	: testing(false), initialized(false), scheduler(nullptr), cpuCycles(0), cpuCycleRunning(false) {
+	: cpuCycles(0), cpuCycleRunning(false), memoryMapWriter(memoryManager, cpuCycles), scheduler(nullptr),
+	testing(false), initialized(false) {
 	mainConsole = new MainConsole(*this);
+	AsyncLogWriter::setCycleSource(&cpuCycles);
 }
 
 ConsoleManager::~ConsoleManager() {
 	stopSchedulerTest();
 	stopCpuCycleCounter();
+	memoryMapWriter.stop();
 	if (scheduler) {
 		scheduler->stop();
 		delete scheduler;
 	}
+	// Queued swap requests reference the processes deleted below
+	memoryManager.stopSwapIo();
 	delete mainConsole;
 	for (auto& pair : processes) {
 		delete pair.second;
@@ -38,13 +52,29 @@ bool ConsoleManager::initialize() {
 
 	memoryManager.initialize(
 		config.getMaxOverallMem(),
-		config.getMemPerFrame()
+		config.getMemPerFrame(),
+		config.getPageReplacement(),
+		config.getAllocationPolicy(),
+		config.getMemoryMode(),
+		static_cast<unsigned int>(config.getNumCpu())
 	);
+	memoryManager.setCompactionThreshold(config.getCompactionThreshold());
+	memoryManager.setSwapVictimPolicy(config.getSwapVictimPolicy());
+	memoryManager.setPageTableLevels(config.getPageTableLevels());
+	memoryManager.configureHugePages(config.getHugePageRatio(), config.getHugePageMinMem());
+	memoryManager.configureTlb(config.getTlbEntries(), config.getTlbAssociativity(), config.getTlbReplacement(),
+		config.getTlbContextSwitch() == "asid");
+	memoryManager.configureSwapIo(config.getSwapIoThreads(), config.getSwapLatency(), config.getSwapBandwidth());
+	memoryManager.setWorkingSetWindow(config.getWorkingSetWindow());
+	if (config.getMemmapInterval() > 0) {
+		memoryMapWriter.start(MEMMAP_FILE, config.getMemmapInterval());
+	}
 
 	scheduler = SchedulerFactory::createScheduler(config, *this);
 	if (!scheduler) {
 		return false;
 	}
+	cpuLoadMonitor.reset(scheduler->getTotalCores());
 
 	startScheduler();
 	startCpuCycleCounter();
@@ -75,6 +105,10 @@ void ConsoleManager::stopCpuCycleCounter() {
 	}
 }
 
+unsigned int ConsoleManager::getCpuCycles() const {
+	return cpuCycles.load();
+}
+
 void ConsoleManager::cpuCycleLoop() {
 	while (true) {
 		{
@@ -83,6 +117,14 @@ void ConsoleManager::cpuCycleLoop() {
 		}
 		std::this_thread::sleep_for(std::chrono::milliseconds(1));
 		cpuCycles++;
+		memoryManager.compactIncrementally();
+		if (scheduler) {
+			cpuLoadMonitor.sample(*scheduler->getSnapshot());
+		}
+
+		if (cpuCycles.load() % RETIRE_INTERVAL_CYCLES == 0) {
+			retireFinishedProcesses();
+		}
 	}
 }
 
@@ -122,9 +164,9 @@ void ConsoleManager::switchToScreen(Process* process) {
 	screen.run();
 }
 
-bool ConsoleManager::createProcess(const std::string& name) {
+bool ConsoleManager::createProcess(const std::string& name, unsigned int numInstructions) {
 	std::lock_guard<std::mutex> lock(processMutex);
-	if (processes.find(name) == processes.end()) {
+	if (processes.find(name) == processes.end() && !processArchive.contains(name)) {
 		Process* process = new Process(name);
 
 		// Set memory size for the process
@@ -144,20 +186,25 @@ bool ConsoleManager::createProcess(const std::string& name) {
 
 		process->setMemorySize(memSize);
 
-		// Try to allocate memory for the process
+		// Instructions must be in place before the scheduler can see the process
+		addGeneratedInstructions(process, numInstructions);
+
+		// Try to allocate memory for the process. Running processes are never
+		// swapped out to make room, so when memory is short the process is
+		// queued anyway and the scheduler admits it once space frees up.
 		try {
-			if (memoryManager.allocateMemory(process, memSize)) {
-				processes[name] = process;
-				scheduler->addProcess(process);
-				return true;
-			}
-			else {
-				// Not enough memory, cannot create process
-				delete process;
-				std::cout << "Not enough memory to create process '" << name
-					<< "' (required: " << memSize << " KB).\n";
-				return false;
+			memoryManager.allocateMemory(process, memSize);
+			// Processes share one of a few segments, so identical workloads keep one copy of it
+			if (config.getSharedSegmentSize() > 0 && memoryManager.isPaging()) {
+				std::string segmentName = "shm" + std::to_string(process->getId() % config.getSharedSegments());
+				if (!memoryManager.attachSharedSegment(process, segmentName, config.getSharedSegmentSize())) {
+					// The process still runs, with all of its memory private
+					std::cout << "Process '" << name << "' could not map shared segment '" << segmentName << "'.\n";
+				}
 			}
+			processes[name] = process;
+			scheduler->addProcess(process);
+			return true;
 		}
 		catch (const std::exception& e) {
 			delete process;
@@ -172,6 +219,62 @@ bool ConsoleManager::createProcess(const std::string& name) {
 	}
 }
 
+bool ConsoleManager::forkProcess(const std::string& parentName, const std::string& childName) {
+	// Console commands run with retirement held off, so the parent outlives the fork
+	Process* parent;
+	Process* child;
+	{
+		std::lock_guard<std::mutex> lock(processMutex);
+		auto it = processes.find(parentName);
+		if (it == processes.end()) {
+			std::cout << "No process found with name '" << parentName << "'.\n";
+			return false;
+		}
+		parent = it->second;
+		child = createChildLocked(parent, childName);
+	}
+	return startChild(parent, child);
+}
+
+bool ConsoleManager::forkProcess(Process* parent, std::string& childName) {
+	// The parent is running the FORK, so it cannot be retired meanwhile
+	Process* child;
+	{
+		std::lock_guard<std::mutex> lock(processMutex);
+		childName = parent->getName() + "-fork" + std::to_string(forkCounter++);
+		child = createChildLocked(parent, childName);
+	}
+	return startChild(parent, child);
+}
+
+Process* ConsoleManager::createChildLocked(Process* parent, const std::string& childName) {
+	if (processes.find(childName) != processes.end() || processArchive.contains(childName)) {
+		std::cout << "Process with name '" << childName << "' already exists.\n";
+		return nullptr;
+	}
+	if (parent->isCompleted()) {
+		std::cout << "Process '" << parent->getName() << "' has finished; there is nothing to fork.\n";
+		return nullptr;
+	}
+
+	// The child shares the parent's instructions; registering it reserves the name
+	Process* child = new Process(childName, *parent);
+	processes[childName] = child;
+	return child;
+}
+
+bool ConsoleManager::startChild(Process* parent, Process* child) {
+	if (child == nullptr) {
+		return false;
+	}
+	// In paging mode the child maps the parent's resident frames until either
+	// side writes to them. Copying the mappings is done without processMutex,
+	// so process lookups and creation do not wait on it.
+	memoryManager.forkMemory(parent, child);
+	scheduler->addProcess(child);
+	return true;
+}
+
 Process* ConsoleManager::getProcess(const std::string& name) {
 	std::lock_guard<std::mutex> lock(processMutex);
 	auto it = processes.find(name);
@@ -188,10 +291,43 @@ std::map<std::string, Process*>& ConsoleManager::getProcesses() {
 	return processes;
 }
 
+void ConsoleManager::retireFinishedProcesses() {
+	// Skip this round while the console is reading process state
+	std::unique_lock<std::mutex> retireLock(retireMutex, std::try_to_lock);
+	if (!retireLock.owns_lock() || !scheduler) {
+		return;
+	}
+
+	std::vector<Process*> finishedProcesses = scheduler->takeFinishedProcesses();
+
+	std::lock_guard<std::mutex> lock(processMutex);
+	for (Process* process : finishedProcesses) {
+		processArchive.archive(process);
+		processes.erase(process->getName());
+		delete process;
+	}
+}
+
+const ProcessArchive& ConsoleManager::getProcessArchive() const {
+	return processArchive;
+}
+
+std::mutex& ConsoleManager::getRetireMutex() {
+	return retireMutex;
+}
+
 MemoryManager& ConsoleManager::getMemoryManager() {
 	return memoryManager;
 }
 
+CpuLoadMonitor& ConsoleManager::getCpuLoadMonitor() {
+	return cpuLoadMonitor;
+}
+
+MemoryMapWriter& ConsoleManager::getMemoryMapWriter() {
+	return memoryMapWriter;
+}
+
 Scheduler* ConsoleManager::getScheduler() {
 	return scheduler;
 }
@@ -308,20 +444,13 @@ void ConsoleManager::generateTestProcess(const std::string& baseName, std::strin
 	int processNum = processCounter++;
 	std::string processName = baseName + std::to_string(processNum);
 
-	if (createProcess(processName)) {
-		Process* process = getProcess(processName);
-		if (process) {
-			Config& config = Config::getInstance();
-			unsigned int numIns = config.getMinIns() + rand() % (config.getMaxIns() - config.getMinIns() + 1);
-
-			for (unsigned int j = 0; j < numIns; ++j) {
-				process->addCommand(new PrintCommand("Hello from " + processName + " Instruction " + std::to_string(j + 1)));
-			}
+	Config& config = Config::getInstance();
+	unsigned int numIns = config.getMinIns() + rand() % (config.getMaxIns() - config.getMinIns() + 1);
 
-			// Only output if we're in batch mode (-p flag)
-			if (outputStream) {
-				*outputStream << "Generated process: " << processName << " with " << numIns << " print commands.\n";
-			}
+	if (createProcess(processName, numIns)) {
+		// Only output if we're in batch mode (-p flag)
+		if (outputStream) {
+			*outputStream << "Generated process: " << processName << " with " << numIns << " instructions.\n";
 		}
 	}
 	else if (outputStream) {
@@ -329,6 +458,36 @@ void ConsoleManager::generateTestProcess(const std::string& baseName, std::strin
 	}
 }
 
+void ConsoleManager::addGeneratedInstructions(Process* process, unsigned int numInstructions) {
+	static const unsigned int NUM_VARIABLES = 4;
+
+	Config& config = Config::getInstance();
+	AccessPatternGenerator addresses(config.getAccessPattern(), process->getMemorySize(), config.getMemPerFrame(),
+		static_cast<unsigned int>(process->getId()));
+	unsigned int memAccessPercent = config.getMemAccessPercent();
+	unsigned int forkPercent = config.getForkPercent();
+	const std::string& name = process->getName();
+
+	for (unsigned int i = 0; i < numInstructions; ++i) {
+		if (forkPercent > 0 && rand() % 100 < static_cast<int>(forkPercent)) {
+			process->addCommand(new ForkCommand(*this));
+		}
+		else if (memAccessPercent == 0 || rand() % 100 >= static_cast<int>(memAccessPercent)) {
+			process->addCommand(new PrintCommand("Hello from " + name + " Instruction " + std::to_string(i + 1)));
+		}
+		else if (i < NUM_VARIABLES) {
+			// Variables are declared up front so READs have somewhere to land
+			process->addCommand(new DeclareCommand(memoryManager, "var" + std::to_string(i), static_cast<uint16_t>(rand() % 65536)));
+		}
+		else if (rand() % 2 == 0) {
+			process->addCommand(new ReadCommand(memoryManager, "var" + std::to_string(rand() % NUM_VARIABLES), addresses.nextAddress()));
+		}
+		else {
+			process->addCommand(new WriteCommand(memoryManager, addresses.nextAddress(), static_cast<uint16_t>(rand() % 65536)));
+		}
+	}
+}
+
 void ConsoleManager::startSchedulerTestWithProcesses(int numProcesses) {
 	std::stringstream outputBuffer;
 	std::cout << "Generating " << numProcesses << " processes...\n";
@@ -2,9 +2,12 @@
 
 #include "Config.h"
 #include "Console.h"
+#include "CpuLoadMonitor.h"
 #include "Process.h"
 #include "Scheduler.h"
 #include "MemoryManager.h"
+#include "MemoryMapWriter.h"
+#include "ProcessArchive.h"
 #include <map>
 #include <mutex>
 #include <string>
@@ -17,21 +20,36 @@ class MainConsole;
 
 class ConsoleManager {
 public:
+    // Where memory map snapshots are appended
+    static const char* const MEMMAP_FILE;
+
     ConsoleManager();
     ~ConsoleManager();
 
     void startCpuCycleCounter();
     void stopCpuCycleCounter();
+    unsigned int getCpuCycles() const;
 
     void start();
     void switchToMainConsole();
     void switchToScreen(Process* process);
 
-    bool createProcess(const std::string& name);
+    bool createProcess(const std::string& name, unsigned int numInstructions = 0);
+    // Starts a copy-on-write child of a process that has not finished
+    bool forkProcess(const std::string& parentName, const std::string& childName);
+    // FORK instruction: the child is named after the parent
+    bool forkProcess(Process* parent, std::string& childName);
     Process* getProcess(const std::string& name);
     std::map<std::string, Process*>& getProcesses();
 
+    // Finished processes are freed and kept only as archive records
+    void retireFinishedProcesses();
+    const ProcessArchive& getProcessArchive() const;
+    std::mutex& getRetireMutex();
+
     MemoryManager& getMemoryManager();
+    MemoryMapWriter& getMemoryMapWriter();
+    CpuLoadMonitor& getCpuLoadMonitor();
     Scheduler* getScheduler();
 
     void startScheduler();
@@ -59,6 +77,9 @@ private:
     std::map<std::string, Process*> processes;
     std::mutex processMutex;
 
+    ProcessArchive processArchive;
+    std::mutex retireMutex;
+
     // For CPU cycle functionality
     std::atomic<unsigned int> cpuCycles;
     std::thread cpuCycleThread;
@@ -68,16 +89,25 @@ private:
     void cpuCycleLoop();
 
     MemoryManager memoryManager;
+    MemoryMapWriter memoryMapWriter;
     Scheduler* scheduler;
+    // Sampled from the scheduler's snapshot every CPU cycle
+    CpuLoadMonitor cpuLoadMonitor;
 
     // For scheduler test
     void schedulerTestLoop();
     void generateTestProcess(const std::string& baseName, std::stringstream* outputStream = nullptr);
+    void addGeneratedInstructions(Process* process, unsigned int numInstructions);
+    // processMutex held; null if the child cannot be created
+    Process* createChildLocked(Process* parent, const std::string& childName);
+    // Gives the child its memory and queues it, without processMutex
+    bool startChild(Process* parent, Process* child);
     std::thread testThread;
     bool testing;
     std::mutex testMutex;
     std::condition_variable testCV;
     std::atomic<int> processCounter{ 1 };
+    std::atomic<int> forkCounter{ 1 };
 
     // Console output management
     std::string currentPrompt;
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+class Process;
+
+struct FragmentationStats {
+    size_t freeBytes;
+    size_t freeBlocks;
+    size_t allocatedBlocks;
+    size_t largestFreeBlock;
+    // Share of free memory that is not in the largest free block, in percent
+    double externalFragmentation;
+    // Share of reserved memory the owners did not ask for, in percent
+    double internalFragmentation;
+};
+
+// One block, as seen in an address-ordered memory map; owner is nullptr for holes
+struct BlockInfo {
+    size_t offset;
+    size_t size;
+    Process* owner;
+};
+
+// Backend for contiguous (non-paged) memory; each process owns at most one block
+class ContiguousAllocator {
+public:
+    virtual ~ContiguousAllocator() = default;
+
+    virtual bool allocate(Process* owner, size_t size) = 0;
+    // Returns the number of bytes released, or 0 if the process had no block
+    virtual size_t release(Process* owner) = 0;
+    virtual bool contains(Process* owner) const = 0;
+
+    // Allocated blocks as (process, size) in address order
+    virtual std::vector<std::pair<Process*, size_t>> getAllocations() const = 0;
+    virtual std::vector<BlockInfo> getBlocks() const = 0;
+
+    virtual size_t getCapacity() const = 0;
+    // Bytes reserved by allocated blocks, including any rounding
+    virtual size_t getUsed() const = 0;
+    virtual FragmentationStats getFragmentationStats() const = 0;
+    virtual std::string getName() const = 0;
+
+    // Slides up to maxMoves allocated blocks toward address 0, merging the
+    // holes they leave behind. Returns the bytes moved; 0 once memory is
+    // compact or the backend cannot relocate blocks.
+    virtual size_t compact(size_t /*maxMoves*/) { return 0; }
+};
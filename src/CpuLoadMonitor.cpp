@@ -0,0 +1,149 @@
+#include "CpuLoadMonitor.h"
+#include <algorithm>
+#include <cmath>
+
+static const unsigned int WINDOW_SECONDS[3] = { 1, 5, 15 };
+// Sliding windows advance a bucket at a time
+static const std::chrono::milliseconds BUCKET_LENGTH(100);
+static const size_t BUCKETS_PER_SECOND = 1000 / BUCKET_LENGTH.count();
+static const size_t NUM_BUCKETS = 15 * BUCKETS_PER_SECOND + 1;
+// Load averages take the mean length over this much time as each new sample
+static const std::chrono::milliseconds LOAD_UPDATE_INTERVAL(50);
+
+CpuLoadMonitor::CpuLoadMonitor()
+    : numCores(0), currentBucket(0), currentBucketNumber(0), runnableSum(0.0), queuedSum(0.0),
+    sinceUpdate(Clock::duration::zero()) {
+    for (int i = 0; i < 3; ++i) {
+        load[i] = 0.0;
+        runQueue[i] = 0.0;
+    }
+}
+
+void CpuLoadMonitor::reset(int numCores) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->numCores = numCores;
+    activeTicks.assign(numCores, 0);
+    idleTicks.assign(numCores, 0);
+    activeBuckets.assign(numCores, std::vector<uint64_t>(NUM_BUCKETS, 0));
+    bucketMicros.assign(NUM_BUCKETS, 0);
+    currentBucket = 0;
+    currentBucketNumber = 0;
+    start = Clock::now();
+    lastSample = start;
+    runnableSum = 0.0;
+    queuedSum = 0.0;
+    sinceUpdate = Clock::duration::zero();
+    for (int i = 0; i < 3; ++i) {
+        load[i] = 0.0;
+        runQueue[i] = 0.0;
+    }
+}
+
+void CpuLoadMonitor::advanceLocked(Clock::time_point time) {
+    uint64_t bucketNumber = static_cast<uint64_t>((time - start) / BUCKET_LENGTH);
+    // After a gap longer than every window, each bucket is simply emptied once
+    uint64_t steps = std::min<uint64_t>(bucketNumber - std::min(bucketNumber, currentBucketNumber), NUM_BUCKETS);
+    for (uint64_t step = 0; step < steps; ++step) {
+        // The oldest bucket is reused for the next one
+        currentBucket = (currentBucket + 1) % NUM_BUCKETS;
+        bucketMicros[currentBucket] = 0;
+        for (int core = 0; core < numCores; ++core) {
+            activeBuckets[core][currentBucket] = 0;
+        }
+    }
+    currentBucketNumber = std::max(currentBucketNumber, bucketNumber);
+}
+
+void CpuLoadMonitor::sample(const SchedulerSnapshot& snapshot) {
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (numCores == 0 || now <= lastSample) {
+        return;
+    }
+
+    std::vector<char> busy(numCores, 0);
+    for (const auto& pair : snapshot.running) {
+        if (pair.second >= 0 && pair.second < numCores) {
+            busy[pair.second] = 1;
+        }
+    }
+    for (int core = 0; core < numCores; ++core) {
+        if (busy[core]) {
+            activeTicks[core]++;
+        }
+        else {
+            idleTicks[core]++;
+        }
+    }
+
+    // The state seen now stands for the time since the last sample, split
+    // over the buckets that time spans; only the longest window is kept
+    Clock::time_point from = std::max(lastSample, now - static_cast<int>(NUM_BUCKETS) * BUCKET_LENGTH);
+    while (from < now) {
+        advanceLocked(from);
+        Clock::time_point bucketEnd = start + static_cast<Clock::rep>(currentBucketNumber + 1) * BUCKET_LENGTH;
+        Clock::time_point to = std::min(now, bucketEnd);
+        uint64_t micros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+        bucketMicros[currentBucket] += micros;
+        for (int core = 0; core < numCores; ++core) {
+            if (busy[core]) {
+                activeBuckets[core][currentBucket] += micros;
+            }
+        }
+        from = to;
+    }
+    advanceLocked(now);
+
+    Clock::duration elapsed = now - lastSample;
+    lastSample = now;
+    double elapsedSeconds = std::chrono::duration<double>(elapsed).count();
+    runnableSum += (snapshot.running.size() + snapshot.queued.size()) * elapsedSeconds;
+    queuedSum += snapshot.queued.size() * elapsedSeconds;
+    sinceUpdate += elapsed;
+    if (sinceUpdate >= LOAD_UPDATE_INTERVAL) {
+        double intervalSeconds = std::chrono::duration<double>(sinceUpdate).count();
+        double runnable = runnableSum / intervalSeconds;
+        double queued = queuedSum / intervalSeconds;
+        for (int i = 0; i < 3; ++i) {
+            double decay = std::exp(-intervalSeconds / WINDOW_SECONDS[i]);
+            load[i] = load[i] * decay + runnable * (1.0 - decay);
+            runQueue[i] = runQueue[i] * decay + queued * (1.0 - decay);
+        }
+        runnableSum = 0.0;
+        queuedSum = 0.0;
+        sinceUpdate = Clock::duration::zero();
+    }
+}
+
+double CpuLoadMonitor::utilizationLocked(const std::vector<uint64_t>& buckets, size_t seconds) const {
+    // The filling bucket and the full ones before it that make up the window
+    uint64_t active = 0;
+    uint64_t micros = 0;
+    for (size_t back = 0; back < seconds * BUCKETS_PER_SECOND; ++back) {
+        size_t bucket = (currentBucket + NUM_BUCKETS - back) % NUM_BUCKETS;
+        active += buckets[bucket];
+        micros += bucketMicros[bucket];
+    }
+    return micros > 0 ? 100.0 * active / micros : 0.0;
+}
+
+CpuLoadStats CpuLoadMonitor::getStats() const {
+    CpuLoadStats stats;
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.numCores = numCores;
+    stats.load = { load[0], load[1], load[2] };
+    stats.runQueue = { runQueue[0], runQueue[1], runQueue[2] };
+    stats.coreActiveTicks = activeTicks;
+    stats.coreIdleTicks = idleTicks;
+    for (int core = 0; core < numCores; ++core) {
+        LoadAverages utilization;
+        utilization.oneSecond = utilizationLocked(activeBuckets[core], WINDOW_SECONDS[0]);
+        utilization.fiveSeconds = utilizationLocked(activeBuckets[core], WINDOW_SECONDS[1]);
+        utilization.fifteenSeconds = utilizationLocked(activeBuckets[core], WINDOW_SECONDS[2]);
+        stats.coreUtilization.push_back(utilization);
+        stats.utilization.oneSecond += utilization.oneSecond / numCores;
+        stats.utilization.fiveSeconds += utilization.fiveSeconds / numCores;
+        stats.utilization.fifteenSeconds += utilization.fifteenSeconds / numCores;
+    }
+    return stats;
+}
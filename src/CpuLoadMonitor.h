@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "ProcessRegistry.h"
+
+// A figure over the last 1, 5 and 15 seconds of wall-clock time
+struct LoadAverages {
+    double oneSecond = 0.0;
+    double fiveSeconds = 0.0;
+    double fifteenSeconds = 0.0;
+};
+
+struct CpuLoadStats {
+    int numCores = 0;
+    LoadAverages load;                  // Running plus queued processes, exponentially weighted
+    LoadAverages runQueue;              // Queued processes alone, exponentially weighted
+    LoadAverages utilization;           // Percent of core time busy, over sliding windows
+    std::vector<LoadAverages> coreUtilization;
+    std::vector<uint64_t> coreActiveTicks;
+    std::vector<uint64_t> coreIdleTicks;
+};
+
+// Turns the scheduler's per-cycle state into figures that hold still between
+// refreshes. Samples are timestamped, and the state each one sees counts for
+// the time since the one before it, so the figures follow the clock however
+// long a cycle takes. Tick counts are per sample. The run-queue length feeds
+// load averages like those of uptime(1).
+class CpuLoadMonitor {
+public:
+    CpuLoadMonitor();
+
+    void reset(int numCores);
+    // Called once per CPU cycle
+    void sample(const SchedulerSnapshot& snapshot);
+    CpuLoadStats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Moves the filling bucket forward to the one holding the given time
+    void advanceLocked(Clock::time_point time);
+    double utilizationLocked(const std::vector<uint64_t>& buckets, size_t seconds) const;
+
+    mutable std::mutex mutex;
+    int numCores;
+
+    std::vector<uint64_t> activeTicks;
+    std::vector<uint64_t> idleTicks;
+
+    // Busy microseconds per core in short buckets covering the longest
+    // window; the bucket at currentBucket is still filling
+    std::vector<std::vector<uint64_t>> activeBuckets;
+    std::vector<uint64_t> bucketMicros;     // Time sampled in each bucket
+    size_t currentBucket;
+    uint64_t currentBucketNumber;           // Buckets since start
+    Clock::time_point start;
+    Clock::time_point lastSample;
+
+    // Lengths integrated over the time since the load averages were last updated
+    double runnableSum;
+    double queuedSum;
+    Clock::duration sinceUpdate;
+    double load[3];
+    double runQueue[3];
+};
@@ -0,0 +1,19 @@
+#include "DeclareCommand.h"
+#include "Process.h"
+#include "MemoryManager.h"
+
+DeclareCommand::DeclareCommand(MemoryManager& memoryManager, const std::string& variable, uint16_t value)
+    : memoryManager(memoryManager), variable(variable), value(value) {}
+
+void DeclareCommand::execute(Process* process, int coreId) {
+    unsigned int address;
+    if (!process->declareVariable(variable, address)) {
+        // Symbol table is full; the declaration is ignored
+        return;
+    }
+    memoryManager.writeMemory(process, address, value, coreId);
+}
+
+std::string DeclareCommand::getDescription() const {
+    return "declare " + variable + " " + std::to_string(value);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Command.h"
+#include <cstdint>
+
+class MemoryManager;
+
+// DECLARE var value: stores a variable in the process's symbol table
+class DeclareCommand : public Command {
+public:
+    DeclareCommand(MemoryManager& memoryManager, const std::string& variable, uint16_t value);
+    void execute(Process* process, int coreId) override;
+    std::string getDescription() const override;
+
+private:
+    MemoryManager& memoryManager;
+    std::string variable;
+    uint16_t value;
+};
@@ -0,0 +1,347 @@
+#include "FlatAllocator.h"
+#include <algorithm>
+
+FlatAllocator::FlatAllocator()
+    : capacity(0), used(0), policy(AllocationPolicy::FirstFit), nextFitCursor(0),
+    rngState(2463534242u), freeTree(nullptr) {}
+
+FlatAllocator::~FlatAllocator() {
+    destroy(freeTree);
+}
+
+void FlatAllocator::initialize(size_t capacity, AllocationPolicy policy) {
+    destroy(freeTree);
+    freeTree = nullptr;
+    blocks.clear();
+    freeBySize.clear();
+    ownerOffsets.clear();
+
+    this->capacity = capacity;
+    this->policy = policy;
+    used = 0;
+    nextFitCursor = 0;
+
+    if (capacity > 0) {
+        blocks[0] = { capacity, nullptr };
+        addFree(0, capacity);
+    }
+}
+
+bool FlatAllocator::parsePolicy(const std::string& name, AllocationPolicy& policy) {
+    if (name == "first-fit") policy = AllocationPolicy::FirstFit;
+    else if (name == "best-fit") policy = AllocationPolicy::BestFit;
+    else if (name == "worst-fit") policy = AllocationPolicy::WorstFit;
+    else if (name == "next-fit") policy = AllocationPolicy::NextFit;
+    else return false;
+    return true;
+}
+
+std::string FlatAllocator::getPolicyName(AllocationPolicy policy) {
+    switch (policy) {
+    case AllocationPolicy::BestFit: return "best-fit";
+    case AllocationPolicy::WorstFit: return "worst-fit";
+    case AllocationPolicy::NextFit: return "next-fit";
+    default: return "first-fit";
+    }
+}
+
+AllocationPolicy FlatAllocator::getPolicy() const {
+    return policy;
+}
+
+bool FlatAllocator::allocate(Process* owner, size_t size) {
+    if (size == 0 || ownerOffsets.count(owner) > 0) {
+        return false;
+    }
+
+    size_t offset;
+    if (!findFreeBlock(size, offset)) {
+        return false;
+    }
+
+    size_t blockSize = blocks[offset].size;
+    removeFree(offset, blockSize);
+    blocks[offset] = { size, owner };
+
+    // Split off the unused tail as a new hole
+    if (blockSize > size) {
+        blocks[offset + size] = { blockSize - size, nullptr };
+        addFree(offset + size, blockSize - size);
+    }
+
+    ownerOffsets[owner] = offset;
+    used += size;
+    nextFitCursor = offset + size;
+    return true;
+}
+
+size_t FlatAllocator::release(Process* owner) {
+    auto ownerIt = ownerOffsets.find(owner);
+    if (ownerIt == ownerOffsets.end()) {
+        return 0;
+    }
+
+    auto it = blocks.find(ownerIt->second);
+    ownerOffsets.erase(ownerIt);
+    size_t released = it->second.size;
+    used -= released;
+
+    size_t offset = it->first;
+    size_t size = released;
+
+    // Coalesce with the following hole
+    auto next = std::next(it);
+    if (next != blocks.end() && next->second.owner == nullptr) {
+        removeFree(next->first, next->second.size);
+        size += next->second.size;
+        blocks.erase(next);
+    }
+
+    // Coalesce with the preceding hole
+    if (it != blocks.begin()) {
+        auto prev = std::prev(it);
+        if (prev->second.owner == nullptr) {
+            removeFree(prev->first, prev->second.size);
+            offset = prev->first;
+            size += prev->second.size;
+            blocks.erase(it);
+            it = prev;
+        }
+    }
+
+    it->second = { size, nullptr };
+    addFree(offset, size);
+    return released;
+}
+
+bool FlatAllocator::contains(Process* owner) const {
+    return ownerOffsets.count(owner) > 0;
+}
+
+std::vector<std::pair<Process*, size_t>> FlatAllocator::getAllocations() const {
+    std::vector<std::pair<Process*, size_t>> result;
+    for (const auto& entry : blocks) {
+        if (entry.second.owner != nullptr) {
+            result.emplace_back(entry.second.owner, entry.second.size);
+        }
+    }
+    return result;
+}
+
+std::vector<BlockInfo> FlatAllocator::getBlocks() const {
+    std::vector<BlockInfo> result;
+    result.reserve(blocks.size());
+    for (const auto& entry : blocks) {
+        result.push_back({ entry.first, entry.second.size, entry.second.owner });
+    }
+    return result;
+}
+
+size_t FlatAllocator::getCapacity() const {
+    return capacity;
+}
+
+size_t FlatAllocator::getUsed() const {
+    return used;
+}
+
+FragmentationStats FlatAllocator::getFragmentationStats() const {
+    FragmentationStats stats;
+    stats.freeBytes = capacity - used;
+    stats.freeBlocks = freeBySize.size();
+    stats.allocatedBlocks = ownerOffsets.size();
+    stats.largestFreeBlock = freeBySize.empty() ? 0 : freeBySize.rbegin()->first;
+    stats.externalFragmentation = stats.freeBytes > 0
+        ? (1.0 - static_cast<double>(stats.largestFreeBlock) / stats.freeBytes) * 100.0
+        : 0.0;
+    // Blocks are cut to the exact requested size
+    stats.internalFragmentation = 0.0;
+    return stats;
+}
+
+std::string FlatAllocator::getName() const {
+    return getPolicyName(policy);
+}
+
+size_t FlatAllocator::compact(size_t maxMoves) {
+    size_t bytesMoved = 0;
+
+    for (size_t move = 0; move < maxMoves; ++move) {
+        // Lowest hole, and the allocated block right after it
+        FreeNode* lowestHole = firstFit(freeTree, 1);
+        if (lowestHole == nullptr) {
+            break;
+        }
+        size_t holeOffset = lowestHole->offset;
+        size_t holeSize = lowestHole->size;
+
+        auto holeIt = blocks.find(holeOffset);
+        auto blockIt = std::next(holeIt);
+        if (blockIt == blocks.end()) {
+            // The only hole is already at the top of memory
+            break;
+        }
+
+        Block moved = blockIt->second;
+        removeFree(holeOffset, holeSize);
+        blocks.erase(blockIt);
+
+        holeIt->second = moved;
+        ownerOffsets[moved.owner] = holeOffset;
+        bytesMoved += moved.size;
+
+        // The hole now sits after the moved block; absorb the next hole if any
+        size_t newHoleOffset = holeOffset + moved.size;
+        size_t newHoleSize = holeSize;
+        auto nextIt = blocks.lower_bound(newHoleOffset);
+        if (nextIt != blocks.end() && nextIt->second.owner == nullptr) {
+            removeFree(nextIt->first, nextIt->second.size);
+            newHoleSize += nextIt->second.size;
+            blocks.erase(nextIt);
+        }
+        blocks[newHoleOffset] = { newHoleSize, nullptr };
+        addFree(newHoleOffset, newHoleSize);
+    }
+
+    if (nextFitCursor > capacity) {
+        nextFitCursor = 0;
+    }
+    return bytesMoved;
+}
+
+bool FlatAllocator::findFreeBlock(size_t size, size_t& offset) {
+    FreeNode* node = nullptr;
+
+    switch (policy) {
+    case AllocationPolicy::BestFit: {
+        auto it = freeBySize.lower_bound(std::make_pair(size, static_cast<size_t>(0)));
+        if (it == freeBySize.end()) return false;
+        offset = it->second;
+        return true;
+    }
+    case AllocationPolicy::WorstFit: {
+        if (freeBySize.empty() || freeBySize.rbegin()->first < size) return false;
+        offset = freeBySize.rbegin()->second;
+        return true;
+    }
+    case AllocationPolicy::NextFit:
+        node = firstFitFrom(freeTree, nextFitCursor, size);
+        if (node == nullptr) {
+            // Wrap around to the start of memory
+            node = firstFit(freeTree, size);
+        }
+        break;
+    default:
+        node = firstFit(freeTree, size);
+        break;
+    }
+
+    if (node == nullptr) {
+        return false;
+    }
+    offset = node->offset;
+    return true;
+}
+
+void FlatAllocator::addFree(size_t offset, size_t size) {
+    freeBySize.insert(std::make_pair(size, offset));
+
+    FreeNode* node = new FreeNode{ offset, size, size, nextPriority(), nullptr, nullptr };
+    FreeNode* left;
+    FreeNode* right;
+    split(freeTree, offset, left, right);
+    freeTree = merge(merge(left, node), right);
+}
+
+void FlatAllocator::removeFree(size_t offset, size_t size) {
+    freeBySize.erase(std::make_pair(size, offset));
+
+    FreeNode* left;
+    FreeNode* middle;
+    FreeNode* right;
+    split(freeTree, offset, left, middle);
+    split(middle, offset + 1, middle, right);
+    destroy(middle);
+    freeTree = merge(left, right);
+}
+
+void FlatAllocator::update(FreeNode* node) {
+    node->maxSize = node->size;
+    if (node->left) node->maxSize = std::max(node->maxSize, node->left->maxSize);
+    if (node->right) node->maxSize = std::max(node->maxSize, node->right->maxSize);
+}
+
+void FlatAllocator::split(FreeNode* node, size_t offset, FreeNode*& left, FreeNode*& right) {
+    // left gets offsets below the split point, right the rest
+    if (node == nullptr) {
+        left = right = nullptr;
+    }
+    else if (node->offset < offset) {
+        split(node->right, offset, node->right, right);
+        left = node;
+        update(left);
+    }
+    else {
+        split(node->left, offset, left, node->left);
+        right = node;
+        update(right);
+    }
+}
+
+FlatAllocator::FreeNode* FlatAllocator::merge(FreeNode* left, FreeNode* right) {
+    if (left == nullptr) return right;
+    if (right == nullptr) return left;
+
+    if (left->priority > right->priority) {
+        left->right = merge(left->right, right);
+        update(left);
+        return left;
+    }
+    right->left = merge(left, right->left);
+    update(right);
+    return right;
+}
+
+FlatAllocator::FreeNode* FlatAllocator::firstFit(FreeNode* node, size_t size) {
+    while (node != nullptr && node->maxSize >= size) {
+        if (node->left && node->left->maxSize >= size) {
+            node = node->left;
+        }
+        else if (node->size >= size) {
+            return node;
+        }
+        else {
+            node = node->right;
+        }
+    }
+    return nullptr;
+}
+
+FlatAllocator::FreeNode* FlatAllocator::firstFitFrom(FreeNode* node, size_t start, size_t size) {
+    if (node == nullptr || node->maxSize < size) {
+        return nullptr;
+    }
+    if (node->offset < start) {
+        return firstFitFrom(node->right, start, size);
+    }
+
+    FreeNode* found = firstFitFrom(node->left, start, size);
+    if (found) return found;
+    if (node->size >= size) return node;
+    return firstFit(node->right, size);
+}
+
+void FlatAllocator::destroy(FreeNode* node) {
+    if (node == nullptr) return;
+    destroy(node->left);
+    destroy(node->right);
+    delete node;
+}
+
+uint32_t FlatAllocator::nextPriority() {
+    // xorshift32
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
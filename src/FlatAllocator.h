@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ContiguousAllocator.h"
+#include <cstdint>
+#include <map>
+#include <set>
+#include <unordered_map>
+
+enum class AllocationPolicy { FirstFit, BestFit, WorstFit, NextFit };
+
+// Contiguous allocator for flat memory, one block per process.
+// All blocks are indexed by address for O(log n) coalescing; free blocks are
+// additionally indexed by size (best/worst fit) and kept in a treap keyed by
+// address and augmented with the largest free size in each subtree (first/next fit).
+class FlatAllocator : public ContiguousAllocator {
+public:
+    FlatAllocator();
+    ~FlatAllocator() override;
+
+    void initialize(size_t capacity, AllocationPolicy policy);
+
+    static bool parsePolicy(const std::string& name, AllocationPolicy& policy);
+    static std::string getPolicyName(AllocationPolicy policy);
+    AllocationPolicy getPolicy() const;
+
+    bool allocate(Process* owner, size_t size) override;
+    size_t release(Process* owner) override;
+    bool contains(Process* owner) const override;
+
+    std::vector<std::pair<Process*, size_t>> getAllocations() const override;
+    std::vector<BlockInfo> getBlocks() const override;
+
+    size_t getCapacity() const override;
+    size_t getUsed() const override;
+    FragmentationStats getFragmentationStats() const override;
+    std::string getName() const override;
+    size_t compact(size_t maxMoves) override;
+
+private:
+    struct Block {
+        size_t size;
+        Process* owner;
+    };
+
+    struct FreeNode {
+        size_t offset;
+        size_t size;
+        size_t maxSize;
+        uint32_t priority;
+        FreeNode* left;
+        FreeNode* right;
+    };
+
+    void addFree(size_t offset, size_t size);
+    void removeFree(size_t offset, size_t size);
+    bool findFreeBlock(size_t size, size_t& offset);
+
+    static void update(FreeNode* node);
+    static void split(FreeNode* node, size_t offset, FreeNode*& left, FreeNode*& right);
+    static FreeNode* merge(FreeNode* left, FreeNode* right);
+    static FreeNode* firstFit(FreeNode* node, size_t size);
+    static FreeNode* firstFitFrom(FreeNode* node, size_t start, size_t size);
+    static void destroy(FreeNode* node);
+    uint32_t nextPriority();
+
+    size_t capacity;
+    size_t used;
+    AllocationPolicy policy;
+    size_t nextFitCursor;
+    uint32_t rngState;
+
+    std::map<size_t, Block> blocks;
+    std::set<std::pair<size_t, size_t>> freeBySize;
+    FreeNode* freeTree;
+    std::unordered_map<Process*, size_t> ownerOffsets;
+};
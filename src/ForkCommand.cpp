@@ -0,0 +1,20 @@
+#include "ForkCommand.h"
+#include "Process.h"
+#include "ConsoleManager.h"
+
+ForkCommand::ForkCommand(ConsoleManager& consoleManager)
+    : consoleManager(consoleManager) {}
+
+void ForkCommand::execute(Process* process, int coreId) {
+    if (process->getParentId() != -1) {
+        return;
+    }
+    std::string childName;
+    if (consoleManager.forkProcess(process, childName)) {
+        process->log("Forked " + childName + ".", coreId);
+    }
+}
+
+std::string ForkCommand::getDescription() const {
+    return "fork";
+}
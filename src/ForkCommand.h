@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Command.h"
+
+class ConsoleManager;
+
+// FORK: starts a copy-on-write child that resumes after this instruction.
+// Forked processes skip it, so a program's FORKs fan out one level only.
+class ForkCommand : public Command {
+public:
+    explicit ForkCommand(ConsoleManager& consoleManager);
+    void execute(Process* process, int coreId) override;
+    std::string getDescription() const override;
+
+private:
+    ConsoleManager& consoleManager;
+};
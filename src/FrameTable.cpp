@@ -0,0 +1,54 @@
+#include "FrameTable.h"
+
+FrameTable::FrameTable() : numFrames(0), numChunks(0), materializedChunks(0) {}
+
+FrameTable::~FrameTable() {
+    clear();
+}
+
+void FrameTable::clear() {
+    for (size_t chunk = 0; chunk < numChunks; ++chunk) {
+        delete[] chunks[chunk].load();
+    }
+    chunks.reset();
+    numChunks = 0;
+    materializedChunks = 0;
+}
+
+void FrameTable::initialize(unsigned int numFrames) {
+    clear();
+    this->numFrames = numFrames;
+    numChunks = (static_cast<size_t>(numFrames) + CHUNK_FRAMES - 1) / CHUNK_FRAMES;
+    // Value-initialized, so every chunk pointer starts null
+    chunks.reset(new std::atomic<Frame*>[numChunks]());
+}
+
+unsigned int FrameTable::size() const {
+    return numFrames;
+}
+
+Frame& FrameTable::operator[](int frameNumber) {
+    std::atomic<Frame*>& slot = chunks[frameNumber / CHUNK_FRAMES];
+    Frame* chunk = slot.load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+        // Two threads may race to materialize the same chunk; the loser frees its copy
+        Frame* created = new Frame[CHUNK_FRAMES];
+        if (slot.compare_exchange_strong(chunk, created, std::memory_order_acq_rel)) {
+            chunk = created;
+            materializedChunks++;
+        }
+        else {
+            delete[] created;
+        }
+    }
+    return chunk[frameNumber % CHUNK_FRAMES];
+}
+
+const Frame* FrameTable::find(int frameNumber) const {
+    const Frame* chunk = chunks[frameNumber / CHUNK_FRAMES].load(std::memory_order_acquire);
+    return chunk != nullptr ? &chunk[frameNumber % CHUNK_FRAMES] : nullptr;
+}
+
+size_t FrameTable::getMemoryUsage() const {
+    return numChunks * sizeof(std::atomic<Frame*>) + materializedChunks * CHUNK_FRAMES * sizeof(Frame);
+}
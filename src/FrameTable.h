@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+class Process;
+
+enum class FrameState { Free, Mapped, Evicting };
+
+// state and refCount are guarded by the replacement policy lock; owner and
+// pageNumber are written before the frame is published to the policy. A
+// shared frame's owner is one of the processes mapping it.
+struct Frame {
+    FrameState state = FrameState::Free;
+    Process* owner = nullptr;
+    int pageNumber = -1;
+    bool huge = false;      // First frame of a huge page; pageNumber is its first page
+    unsigned int refCount = 0;  // Page tables mapping the frame; above 1 it is shared copy-on-write
+    int segmentId = -1;         // Shared segment whose table maps the frame; owner is then null
+};
+
+// Frame descriptors for paging mode, materialized a chunk at a time the first
+// time one of their frames is used. Initializing a huge physical memory only
+// allocates the chunk directory. Chunks can be materialized concurrently.
+class FrameTable {
+public:
+    static const unsigned int CHUNK_FRAMES = 1024;
+
+    FrameTable();
+    ~FrameTable();
+
+    void initialize(unsigned int numFrames);
+    unsigned int size() const;
+
+    Frame& operator[](int frameNumber);
+    // Null while the frame's chunk has not been materialized, i.e. the frame is free
+    const Frame* find(int frameNumber) const;
+
+    // Bytes held by the directory and materialized chunks
+    size_t getMemoryUsage() const;
+
+private:
+    void clear();
+
+    unsigned int numFrames;
+    size_t numChunks;
+    std::unique_ptr<std::atomic<Frame*>[]> chunks;
+    std::atomic<size_t> materializedChunks;
+};
@@ -30,6 +30,8 @@ void MainConsole::run() {
             system("CLS");
         }
         else {
+            // Hold off process retirement while a command may be reading process state
+            std::lock_guard<std::mutex> lock(consoleManager.getRetireMutex());
             handleCommand(input);
         }
     }
@@ -99,6 +101,16 @@ void MainConsole::handleCommand(const std::string& input) {
                 std::cout << "Please specify a process name to resume.\n";
             }
         }
+        else if (flag == "-fork") {
+            if (tokens.size() >= 4) {
+                if (consoleManager.forkProcess(tokens[2], tokens[3])) {
+                    std::cout << "Process '" << tokens[3] << "' forked from '" << tokens[2] << "'.\n";
+                }
+            }
+            else {
+                std::cout << "Please specify the process to fork and a name for the child.\n";
+            }
+        }
         else if (flag == "-ls") {
             bool showAll = false;
             if (tokens.size() >= 3 && tokens[2] == "-a") {
@@ -111,9 +123,11 @@ void MainConsole::handleCommand(const std::string& input) {
                 return;
             }
 
-            auto runningProcessesMap = scheduler->getRunningProcesses();
-            auto queuedProcesses = scheduler->getQueuedProcesses();
-            auto finishedProcesses = scheduler->getFinishedProcesses();
+            // One snapshot, so no process shows up in two lists or in none
+            std::shared_ptr<const SchedulerSnapshot> snapshot = scheduler->getSnapshot();
+            const auto& runningProcessesMap = snapshot->running;
+            const auto& queuedProcesses = snapshot->queued;
+            const auto& finishedProcesses = snapshot->finished;
 
             std::vector<Process*> runningProcesses;
             for (const auto& pair : runningProcessesMap) {
@@ -121,14 +135,8 @@ void MainConsole::handleCommand(const std::string& input) {
             }
 
             // Display CPU utilization and core information
-            int totalCores = scheduler->getTotalCores();
-            int busyCores = scheduler->getBusyCores();
-            int availableCores = totalCores - busyCores;
-            double cpuUtilization = ((double)busyCores / totalCores) * 100.0;
-
-            std::cout << "\nCPU utilization: " << std::fixed << std::setprecision(2) << cpuUtilization << "%\n";
-            std::cout << "Cores used: " << busyCores << "\n";
-            std::cout << "Cores available: " << availableCores << "\n";
+            std::cout << "\n";
+            writeCpuLoad(std::cout, static_cast<int>(runningProcessesMap.size()), scheduler->getTotalCores(), false);
 
             std::cout << "\n-------------------------------------------------------";
 
@@ -138,7 +146,7 @@ void MainConsole::handleCommand(const std::string& input) {
 
             displayRunningProcesses(runningProcesses, runningProcessesMap);
 
-            displayFinishedProcesses(finishedProcesses);
+            displayFinishedProcesses(std::cout, finishedProcesses);
 
             std::cout << "-------------------------------------------------------\n\n";
         }
@@ -147,6 +155,7 @@ void MainConsole::handleCommand(const std::string& input) {
             std::cout << "Usage:\n";
             std::cout << "  screen -s [process_name]       : Start a new process\n";
             std::cout << "  screen -r [process_name]       : Resume an existing process\n";
+            std::cout << "  screen -fork [src] [dst]       : Fork a process copy-on-write\n";
             std::cout << "  screen -ls                     : List running and finished processes\n";
             std::cout << "  screen -ls -a                  : List all processes including queued\n";
         }
@@ -157,6 +166,44 @@ void MainConsole::handleCommand(const std::string& input) {
     else if (command == "vmstat") {
         displayVmStat();
     }
+    else if (command == "memmap") {
+        MemoryMapWriter& writer = consoleManager.getMemoryMapWriter();
+        if (tokens.size() == 1) {
+            displayMemoryMap();
+        }
+        else if (tokens[1] == "-w" && tokens.size() >= 3 && tokens[2] == "off") {
+            if (writer.isRunning()) {
+                writer.stop();
+                std::cout << writer.getNumSnapshots() << " memory map snapshots written to " << writer.getPath() << ".\n";
+            }
+            else {
+                std::cout << "Memory map snapshots are not being written.\n";
+            }
+        }
+        else if (tokens[1] == "-w") {
+            unsigned int intervalMs = 100;
+            try {
+                if (tokens.size() >= 3) {
+                    intervalMs = static_cast<unsigned int>(std::stoul(tokens[2]));
+                }
+            }
+            catch (const std::exception&) {
+                std::cout << "Invalid interval. Usage: memmap -w [interval_ms | off]\n";
+                return;
+            }
+            if (intervalMs == 0 || !writer.start(ConsoleManager::MEMMAP_FILE, intervalMs)) {
+                std::cout << "Could not start memory map snapshots.\n";
+                return;
+            }
+            std::cout << "Writing a memory map snapshot every " << intervalMs << " ms to " << writer.getPath() << ".\n";
+        }
+        else {
+            std::cout << "Usage:\n";
+            std::cout << "  memmap                         : Show the physical memory layout\n";
+            std::cout << "  memmap -w [interval_ms]        : Append snapshots to " << ConsoleManager::MEMMAP_FILE << "\n";
+            std::cout << "  memmap -w off                  : Stop writing snapshots\n";
+        }
+    }
     else if (command == "scheduler-pause") {
         consoleManager.pauseScheduler();
     }
@@ -249,7 +296,8 @@ void MainConsole::displayProcessSmi() {
     std::cout << "+---------------------------------------------+\n";
 
     // System Utilization Section
-    double cpuUtilization = ((double)scheduler->getBusyCores() / scheduler->getTotalCores()) * 100.0;
+    CpuLoadStats load = consoleManager.getCpuLoadMonitor().getStats();
+    double cpuUtilization = load.utilization.fiveSeconds;
     unsigned int totalMem = memoryManager.getTotalMemory();
     unsigned int usedMem = memoryManager.getUsedMemory();
     double memUtil = memoryManager.getMemoryUtilization();
@@ -265,23 +313,46 @@ void MainConsole::displayProcessSmi() {
         << std::left << std::setw(10) << totalMemStr.str() << std::string(6, ' ') << "|\n";
     std::cout << "| Memory Usage : " << std::right << std::setw(9) << std::fixed << std::setprecision(1)
         << memUtil << "%" << std::string(19, ' ') << "|\n";
+    std::stringstream loadStr, runQueueStr;
+    loadStr << std::fixed << std::setprecision(2) << load.load.oneSecond << ", " << load.load.fiveSeconds
+        << ", " << load.load.fifteenSeconds;
+    runQueueStr << std::fixed << std::setprecision(2) << load.runQueue.oneSecond << ", " << load.runQueue.fiveSeconds
+        << ", " << load.runQueue.fifteenSeconds;
+    std::cout << "| Load Average : " << std::left << std::setw(29) << loadStr.str() << std::right << "|\n";
+    std::cout << "| Run Queue    : " << std::left << std::setw(29) << runQueueStr.str() << std::right << "|\n";
+
+    // Per-core utilization over the 1, 5 and 15 second windows
+    auto percent = [](double value) {
+        std::stringstream out;
+        out << std::fixed << std::setprecision(1) << value << "%";
+        return out.str();
+    };
+    std::cout << "+---------------------------------------------+\n";
+    std::cout << "|   Core         1s        5s       15s       |\n";
+    std::cout << "|---------------------------------------------|\n";
+    for (int core = 0; core < load.numCores; ++core) {
+        const LoadAverages& utilization = load.coreUtilization[core];
+        std::cout << "|" << std::right << std::setw(7) << core << std::setw(11) << percent(utilization.oneSecond)
+            << std::setw(10) << percent(utilization.fiveSeconds) << std::setw(10) << percent(utilization.fifteenSeconds)
+            << std::string(7, ' ') << "|\n";
+    }
 
     // Process Memory Section
     std::cout << "+---------------------------------------------+\n";
-    std::cout << "|   PID   Process Name          Memory Usage  |\n";
+    std::cout << "|   PID   Process Name      Private   Shared  |\n";
     std::cout << "|---------------------------------------------|\n";
 
     auto processesInMemory = memoryManager.getProcessesInMemory();
     for (const auto& entry : processesInMemory) {
-        Process* process = entry.first;
+        Process* process = entry.process;
         std::string processName = process->getName();
         if (processName.length() > 16) {
             processName = processName.substr(0, 13) + "...";
         }
         std::cout << "| " << std::setw(5) << process->getId() << "   "
-            << std::left << std::setw(16) << processName << " "
-            << std::right << std::setw(9) << entry.second << " KB"
-            << std::string(7, ' ') << "|\n";
+            << std::left << std::setw(16) << processName
+            << std::right << std::setw(6) << entry.privateKB << " KB"
+            << std::setw(6) << entry.sharedKB << " KB" << "  |\n";
     }
 
     if (processesInMemory.empty()) {
@@ -322,8 +393,246 @@ void MainConsole::displayVmStat() {
             << std::string(2, ' ') << "|\n";
         std::cout << "| Pages Out     : " << std::right << std::setw(13) << memoryManager.getNumPagedOut()
             << std::string(2, ' ') << "|\n";
+
+        unsigned int accesses = memoryManager.getNumMemoryAccesses();
+        unsigned int faults = memoryManager.getNumPageFaults();
+        double faultRate = accesses > 0 ? (static_cast<double>(faults) / accesses) * 100.0 : 0.0;
+        std::cout << "| Replacement   : " << std::right << std::setw(13) << memoryManager.getReplacementPolicyName()
+            << std::string(2, ' ') << "|\n";
+        std::cout << "| Page Hits     : " << std::right << std::setw(13) << (accesses - faults)
+            << std::string(2, ' ') << "|\n";
+        std::cout << "| Page Faults   : " << std::right << std::setw(13) << faults
+            << std::string(2, ' ') << "|\n";
+        std::cout << "| Fault Rate    : " << std::right << std::setw(12) << std::fixed << std::setprecision(2) << faultRate
+            << "%" << std::string(2, ' ') << "|\n";
+        std::cout << "| Table Memory  : " << std::right << std::setw(10) << (memoryManager.getTranslationMemoryUsage() + 1023) / 1024
+            << " KB" << std::string(2, ' ') << "|\n";
+
+        if (memoryManager.isHugePagesEnabled()) {
+            HugePageStats huge = memoryManager.getHugePageStats();
+            std::cout << "+--------------------------------+\n";
+            std::cout << "| Huge Pages:                    |\n";
+            std::cout << "| Frames/Huge   : " << std::right << std::setw(13) << huge.ratio
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Mapped        : " << std::right << std::setw(13) << huge.mappings
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Coverage      : " << std::right << std::setw(12) << std::fixed << std::setprecision(2)
+                << huge.coverage << "%" << std::string(2, ' ') << "|\n";
+            std::cout << "| TLB Ents Saved: " << std::right << std::setw(13) << huge.tlbEntriesSaved
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Promotions    : " << std::right << std::setw(13) << huge.promotions
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Demotions     : " << std::right << std::setw(13) << huge.demotions
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Fallbacks     : " << std::right << std::setw(13) << huge.fallbacks
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Base ns/page  : " << std::right << std::setw(13) << std::fixed << std::setprecision(1)
+                << huge.baseAllocNsPerPage << std::string(2, ' ') << "|\n";
+            std::cout << "| Huge ns/page  : " << std::right << std::setw(13) << std::fixed << std::setprecision(1)
+                << huge.hugeAllocNsPerPage << std::string(2, ' ') << "|\n";
+        }
+
+        CopyOnWriteStats cow = memoryManager.getCopyOnWriteStats();
+        if (cow.forks > 0) {
+            std::cout << "+--------------------------------+\n";
+            std::cout << "| Copy-on-Write:                 |\n";
+            std::cout << "| Forks         : " << std::right << std::setw(13) << cow.forks
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Pages Shared  : " << std::right << std::setw(13) << cow.pagesShared
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Shared Frames : " << std::right << std::setw(13) << cow.sharedFrames
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Frames Saved  : " << std::right << std::setw(13) << cow.framesSaved
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| CoW Copies    : " << std::right << std::setw(13) << cow.copies
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| CoW Reuses    : " << std::right << std::setw(13) << cow.reuses
+                << std::string(2, ' ') << "|\n";
+        }
+
+        SharedSegmentStats shm = memoryManager.getSharedSegmentStats();
+        if (shm.segments > 0) {
+            std::cout << "+--------------------------------+\n";
+            std::cout << "| Shared Memory:                 |\n";
+            std::cout << "| Segments      : " << std::right << std::setw(13) << shm.segments
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Mappings      : " << std::right << std::setw(13) << shm.mappings
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Resident      : " << std::right << std::setw(10) << shm.residentKB
+                << " KB" << std::string(2, ' ') << "|\n";
+            std::cout << "| Saved         : " << std::right << std::setw(10) << shm.savedKB
+                << " KB" << std::string(2, ' ') << "|\n";
+        }
+
+        LoadControlStats load = memoryManager.getLoadControlStats();
+        if (load.window > 0) {
+            std::cout << "+--------------------------------+\n";
+            std::cout << "| Load Control:                  |\n";
+            std::cout << "| WS Window     : " << std::right << std::setw(13) << load.window
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Working Sets  : " << std::right << std::setw(6) << load.workingSetPages
+                << " / " << std::left << std::setw(6) << load.capacityPages << std::right << "|\n";
+            std::cout << "| Active        : " << std::right << std::setw(13) << load.activeProcesses
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Suspended     : " << std::right << std::setw(13) << load.suspendedProcesses
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Suspensions   : " << std::right << std::setw(13) << load.suspensions
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Reactivations : " << std::right << std::setw(13) << load.reactivations
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Refused       : " << std::right << std::setw(13) << load.refusals
+                << std::string(2, ' ') << "|\n";
+        }
+
+        if (memoryManager.isTlbEnabled()) {
+            TlbStats tlb = memoryManager.getTlbStats();
+            uint64_t lookups = tlb.hits + tlb.misses;
+            double hitRate = lookups > 0 ? (static_cast<double>(tlb.hits) / lookups) * 100.0 : 0.0;
+            std::cout << "+--------------------------------+\n";
+            std::cout << "| TLB:                           |\n";
+            std::cout << "| Geometry      : " << std::right << std::setw(13) << memoryManager.getTlbConfiguration()
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Ctx Switch    : " << std::right << std::setw(13) << (memoryManager.isTlbAsidTagged() ? "asid" : "flush")
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Hit Rate      : " << std::right << std::setw(12) << std::fixed << std::setprecision(2) << hitRate
+                << "%" << std::string(2, ' ') << "|\n";
+            std::cout << "| Miss Rate     : " << std::right << std::setw(12) << std::fixed << std::setprecision(2)
+                << (lookups > 0 ? 100.0 - hitRate : 0.0) << "%" << std::string(2, ' ') << "|\n";
+            std::cout << "| Flushes       : " << std::right << std::setw(13) << tlb.flushes
+                << std::string(2, ' ') << "|\n";
+            std::cout << "| Shootdowns    : " << std::right << std::setw(13) << tlb.shootdowns
+                << std::string(2, ' ') << "|\n";
+
+            std::vector<TlbStats> perCore = memoryManager.getTlbStatsPerCore();
+            for (size_t core = 0; core < perCore.size(); ++core) {
+                uint64_t coreLookups = perCore[core].hits + perCore[core].misses;
+                double coreHitRate = coreLookups > 0 ? (static_cast<double>(perCore[core].hits) / coreLookups) * 100.0 : 0.0;
+                std::cout << "| " << std::left << std::setw(14) << ("Core " + std::to_string(core) + " Hits") << ": "
+                    << std::right << std::setw(12) << std::fixed << std::setprecision(2) << coreHitRate
+                    << "%" << std::string(2, ' ') << "|\n";
+            }
+        }
+    }
+    else {
+        FragmentationStats fragmentation = memoryManager.getFragmentationStats();
+        std::cout << "+--------------------------------+\n";
+        std::cout << "| Fragmentation:                 |\n";
+        std::cout << "| Policy        : " << std::right << std::setw(13) << memoryManager.getAllocationPolicyName()
+            << std::string(2, ' ') << "|\n";
+        std::cout << "| Free Blocks   : " << std::right << std::setw(13) << fragmentation.freeBlocks
+            << std::string(2, ' ') << "|\n";
+        std::cout << "| Largest Hole  : " << std::right << std::setw(10) << fragmentation.largestFreeBlock
+            << " KB" << std::string(2, ' ') << "|\n";
+        std::cout << "| External Frag : " << std::right << std::setw(12) << std::fixed << std::setprecision(2)
+            << fragmentation.externalFragmentation << "%" << std::string(2, ' ') << "|\n";
+        std::cout << "| Internal Frag : " << std::right << std::setw(12) << std::fixed << std::setprecision(2)
+            << fragmentation.internalFragmentation << "%" << std::string(2, ' ') << "|\n";
+        std::cout << "| Compact Cycles: " << std::right << std::setw(13) << memoryManager.getNumCompactionCycles()
+            << std::string(2, ' ') << "|\n";
+        std::cout << "| Compacted     : " << std::right << std::setw(10) << memoryManager.getCompactionBytesMoved()
+            << " KB" << std::string(2, ' ') << "|\n";
+        std::cout << "| Victim Policy : " << std::right << std::setw(13) << memoryManager.getSwapVictimPolicyName()
+            << std::string(2, ' ') << "|\n";
+        std::cout << "| Evictions     : " << std::right << std::setw(13) << memoryManager.getNumEvictions()
+            << std::string(2, ' ') << "|\n";
+        unsigned int released = memoryManager.getNumProcessesReleased();
+        std::cout << "| Evict/Finish  : " << std::right << std::setw(13) << std::fixed << std::setprecision(2)
+            << (released > 0 ? static_cast<double>(memoryManager.getNumEvictions()) / released : 0.0)
+            << std::string(2, ' ') << "|\n";
+        std::cout << "| Prefetched    : " << std::right << std::setw(13) << memoryManager.getNumPrefetches()
+            << std::string(2, ' ') << "|\n";
+        std::cout << "| Throttled     : " << std::right << std::setw(13) << memoryManager.getNumThrottledAdmissions()
+            << std::string(2, ' ') << "|\n";
     }
 
+    std::cout << "+--------------------------------+\n";
+    std::cout << "| Backing Store:                 |\n";
+    std::cout << "| Slots Used    : " << std::right << std::setw(6) << memoryManager.getSwapSlotsUsed()
+        << " / " << std::left << std::setw(6) << memoryManager.getSwapSlotsTotal() << std::right << "|\n";
+    std::cout << "| Swap Out Ops  : " << std::right << std::setw(13) << memoryManager.getNumSwapWrites()
+        << std::string(2, ' ') << "|\n";
+    std::cout << "| Swap Full     : " << std::right << std::setw(13) << memoryManager.getNumSwapFullWrites()
+        << std::string(2, ' ') << "|\n";
+    std::cout << "| Swap Out      : " << std::right << std::setw(10) << memoryManager.getSwapKBWritten()
+        << " KB" << std::string(2, ' ') << "|\n";
+    std::cout << "| Swap In Ops   : " << std::right << std::setw(13) << memoryManager.getNumSwapReads()
+        << std::string(2, ' ') << "|\n";
+    std::cout << "| Swap In       : " << std::right << std::setw(10) << memoryManager.getSwapKBRead()
+        << " KB" << std::string(2, ' ') << "|\n";
+
+    if (!memoryManager.isPaging()) {
+        // Whole-process swapping goes through the swap engine
+        SwapIoStats io = memoryManager.getSwapIoStats();
+        std::cout << "+--------------------------------+\n";
+        std::cout << "| Swap I/O:                      |\n";
+        std::cout << "| I/O Threads   : " << std::right << std::setw(13)
+            << (io.threads > 0 ? std::to_string(io.threads) : std::string("sync")) << std::string(2, ' ') << "|\n";
+        std::cout << "| Queue Depth   : " << std::right << std::setw(6) << io.queueDepth
+            << " / " << std::left << std::setw(6) << io.maxQueueDepth << std::right << "|\n";
+        std::cout << "| Reads         : " << std::right << std::setw(13) << io.reads
+            << std::string(2, ' ') << "|\n";
+        std::cout << "| Writes        : " << std::right << std::setw(13) << io.writes
+            << std::string(2, ' ') << "|\n";
+        std::cout << "| Latency p50   : " << std::right << std::setw(10) << std::fixed << std::setprecision(0)
+            << io.p50Us << " us" << std::string(2, ' ') << "|\n";
+        std::cout << "| Latency p95   : " << std::right << std::setw(10) << io.p95Us
+            << " us" << std::string(2, ' ') << "|\n";
+        std::cout << "| Latency p99   : " << std::right << std::setw(10) << io.p99Us
+            << " us" << std::string(2, ' ') << "|\n";
+    }
+
+    std::cout << "+--------------------------------+\n\n";
+}
+
+void MainConsole::displayMemoryMap() {
+    // Longer maps are cut short on screen; snapshots always hold every run
+    static const size_t MAX_RUNS_SHOWN = 32;
+    MemoryMap map = consoleManager.getMemoryManager().getMemoryMap();
+
+    std::cout << "\n+--------------------------------+\n";
+    std::cout << "|           Memory Map           |\n";
+    std::cout << "+--------------------------------+\n";
+    std::cout << "| Mode          : " << std::right << std::setw(13) << MemoryMapWriter::describeMode(map)
+        << std::string(2, ' ') << "|\n";
+    std::cout << "| Unit          : " << std::right << std::setw(10) << map.unit
+        << " KB" << std::string(2, ' ') << "|\n";
+    std::cout << "| Used          : " << std::right << std::setw(10) << map.usedKB
+        << " KB" << std::string(2, ' ') << "|\n";
+    std::cout << "| Free          : " << std::right << std::setw(10) << map.freeKB
+        << " KB" << std::string(2, ' ') << "|\n";
+    std::cout << "| Holes         : " << std::right << std::setw(13) << map.holes
+        << std::string(2, ' ') << "|\n";
+    std::cout << "| Largest Hole  : " << std::right << std::setw(10) << map.largestHole
+        << " KB" << std::string(2, ' ') << "|\n";
+    std::cout << "| External Frag : " << std::right << std::setw(12) << std::fixed << std::setprecision(2)
+        << map.externalFragmentation << "%" << std::string(2, ' ') << "|\n";
+    if (!consoleManager.getMemoryManager().isPaging()) {
+        std::cout << "| Refused Admits: " << std::right << std::setw(13) << map.refusedAdmissions
+            << std::string(2, ' ') << "|\n";
+        std::cout << "| Last Refused  : " << std::right << std::setw(10) << map.lastRefusedSize
+            << " KB" << std::string(2, ' ') << "|\n";
+    }
+    std::cout << "+--------------------------------+\n";
+    std::cout << "|    Start    Length  Owner      |\n";
+    std::cout << "|--------------------------------|\n";
+    for (size_t i = 0; i < map.runs.size() && i < MAX_RUNS_SHOWN; ++i) {
+        const MemoryMapRun& run = map.runs[i];
+        std::string owner;
+        switch (run.owner) {
+        case MemoryMapOwner::Free: owner = "free"; break;
+        case MemoryMapOwner::Process: owner = "pid " + std::to_string(run.ownerId); break;
+        case MemoryMapOwner::CopyOnWrite: owner = "cow " + std::to_string(run.ownerId); break;
+        case MemoryMapOwner::HugePage: owner = "huge " + std::to_string(run.ownerId); break;
+        case MemoryMapOwner::Segment: owner = "shm " + std::to_string(run.ownerId); break;
+        case MemoryMapOwner::Evicting: owner = "evicting"; break;
+        }
+        std::cout << "| " << std::right << std::setw(8) << run.start << std::setw(10) << run.length
+            << "  " << std::left << std::setw(11) << owner << std::right << "|\n";
+    }
+    if (map.runs.size() > MAX_RUNS_SHOWN) {
+        std::cout << "| ... " << std::left << std::setw(27)
+            << (std::to_string(map.runs.size() - MAX_RUNS_SHOWN) + " more runs") << std::right << "|\n";
+    }
     std::cout << "+--------------------------------+\n\n";
 }
 
@@ -357,15 +666,17 @@ void MainConsole::displayRunningProcesses(const std::vector<Process*>& runningPr
     }
 }
 
-void MainConsole::displayFinishedProcesses(const std::vector<Process*>& finishedProcesses) {
-    if (finishedProcesses.empty()) {
-        std::cout << "\nNo finished processes.\n";
+void MainConsole::displayFinishedProcesses(std::ostream& out, const std::vector<Process*>& finishedProcesses) {
+    const ProcessArchive& archive = consoleManager.getProcessArchive();
+    std::vector<ArchivedProcess> retiredProcesses = archive.getRecords();
+
+    if (finishedProcesses.empty() && retiredProcesses.empty()) {
+        out << "\nNo finished processes.\n";
         return;
     }
-    std::cout << "\nFinished processes:\n";
-    for (Process* process : finishedProcesses) {
-        std::string processName = process->getName();
-        std::time_t creationTime = process->getCreationTime();
+    out << "\nFinished processes:\n";
+
+    auto printFinished = [&out](const std::string& processName, std::time_t creationTime, int totalLines) {
         std::tm creationTm;
 
         localtime_s(&creationTm, &creationTime);
@@ -374,13 +685,19 @@ void MainConsole::displayFinishedProcesses(const std::vector<Process*>& finished
         std::strftime(timeBuffer, sizeof(timeBuffer), "%m/%d/%Y %I:%M:%S%p", &creationTm);
         std::string timeStr = timeBuffer;
 
-        int totalLines = process->getTotalLines();
-
         // Format: processName  (creationTime)  Finished   totalLines / totalLines
-        std::cout << std::left << std::setw(15) << processName
+        out << std::left << std::setw(15) << processName
             << "(" << timeStr << ")    "
             << "Finished     "
             << totalLines << " / " << totalLines << "\n";
+    };
+
+    // Retired processes finished first, so they are listed before the ones not yet archived
+    for (const ArchivedProcess& record : retiredProcesses) {
+        printFinished(archive.getName(record.nameId), record.creationTime, record.instructionCount);
+    }
+    for (Process* process : finishedProcesses) {
+        printFinished(process->getName(), process->getCreationTime(), process->getTotalLines());
     }
 }
 
@@ -412,6 +729,79 @@ void MainConsole::displayQueuedProcesses(const std::vector<Process*>& queuedProc
     }
 }
 
+void MainConsole::writeSchedulingSummary(std::ostream& out, const std::vector<Process*>& finishedProcesses) {
+    std::vector<ProcessMetrics> allMetrics;
+    for (const ArchivedProcess& record : consoleManager.getProcessArchive().getRecords()) {
+        allMetrics.push_back(record.metrics);
+    }
+    unsigned int now = consoleManager.getCpuCycles();
+    for (Process* process : finishedProcesses) {
+        allMetrics.push_back(process->getMetrics(now));
+    }
+
+    if (allMetrics.empty()) {
+        return;
+    }
+
+    double responseCycles = 0, waitingCycles = 0, runCycles = 0, blockedCycles = 0, turnaroundCycles = 0;
+    double responseMs = 0, waitingMs = 0, runMs = 0, blockedMs = 0, turnaroundMs = 0;
+    unsigned int preemptions = 0, migrations = 0;
+    for (const ProcessMetrics& metrics : allMetrics) {
+        responseCycles += metrics.getResponseCycles();
+        waitingCycles += metrics.waitingCycles;
+        runCycles += metrics.runCycles;
+        blockedCycles += metrics.memoryBlockedCycles;
+        turnaroundCycles += metrics.getTurnaroundCycles();
+        responseMs += metrics.responseMs;
+        waitingMs += metrics.waitingMs;
+        runMs += metrics.runMs;
+        blockedMs += metrics.memoryBlockedMs;
+        turnaroundMs += metrics.turnaroundMs;
+        preemptions += metrics.preemptions;
+        migrations += metrics.migrations;
+    }
+
+    double count = static_cast<double>(allMetrics.size());
+    auto printAverage = [&out, count](const std::string& label, double cycles, double ms) {
+        out << std::left << std::setw(20) << label << ": "
+            << std::fixed << std::setprecision(2) << cycles / count << " cycles ("
+            << ms / count << " ms)\n";
+    };
+
+    out << "\nScheduling metrics (" << allMetrics.size() << " finished processes):\n";
+    printAverage("Avg response time", responseCycles, responseMs);
+    printAverage("Avg waiting time", waitingCycles, waitingMs);
+    printAverage("Avg run time", runCycles, runMs);
+    printAverage("Avg memory blocked", blockedCycles, blockedMs);
+    printAverage("Avg turnaround time", turnaroundCycles, turnaroundMs);
+    out << std::left << std::setw(20) << "Total preemptions" << ": " << preemptions << "\n";
+    out << std::left << std::setw(20) << "Total migrations" << ": " << migrations << "\n";
+}
+
+void MainConsole::writeCpuLoad(std::ostream& out, int busyCores, int totalCores, bool perCore) {
+    CpuLoadStats load = consoleManager.getCpuLoadMonitor().getStats();
+
+    // Averaged over a window, so it does not swing with each refresh
+    out << "CPU utilization: " << std::fixed << std::setprecision(2) << load.utilization.fiveSeconds
+        << "% (1s " << load.utilization.oneSecond << "%, 15s " << load.utilization.fifteenSeconds << "%)\n";
+    out << "Cores used: " << busyCores << "\n";
+    out << "Cores available: " << totalCores - busyCores << "\n";
+    out << "Load average: " << load.load.oneSecond << ", " << load.load.fiveSeconds << ", "
+        << load.load.fifteenSeconds << "\n";
+    out << "Run queue: " << load.runQueue.oneSecond << ", " << load.runQueue.fiveSeconds << ", "
+        << load.runQueue.fifteenSeconds << "\n";
+    if (!perCore) {
+        return;
+    }
+    for (int core = 0; core < load.numCores; ++core) {
+        const LoadAverages& utilization = load.coreUtilization[core];
+        out << "Core " << core << ": " << std::setprecision(1) << utilization.oneSecond << "% 1s, "
+            << utilization.fiveSeconds << "% 5s, " << utilization.fifteenSeconds << "% 15s ("
+            << load.coreActiveTicks[core] << " active / " << load.coreIdleTicks[core] << " idle ticks)\n";
+    }
+    out << std::setprecision(2);
+}
+
 void MainConsole::reportUtil() {
     Scheduler* scheduler = consoleManager.getScheduler();
     if (!scheduler) {
@@ -419,9 +809,11 @@ void MainConsole::reportUtil() {
         return;
     }
 
-    auto runningProcessesMap = scheduler->getRunningProcesses();
-    auto queuedProcesses = scheduler->getQueuedProcesses();
-    auto finishedProcesses = scheduler->getFinishedProcesses();
+    // One snapshot, so no process shows up in two lists or in none
+    std::shared_ptr<const SchedulerSnapshot> snapshot = scheduler->getSnapshot();
+    const auto& runningProcessesMap = snapshot->running;
+    const auto& queuedProcesses = snapshot->queued;
+    const auto& finishedProcesses = snapshot->finished;
 
     std::vector<Process*> runningProcesses;
     for (const auto& pair : runningProcessesMap) {
@@ -441,14 +833,7 @@ void MainConsole::reportUtil() {
     logfile << "Report generated at: " << buffer << "\n";
 
     // Display CPU utilization and core information
-    int totalCores = scheduler->getTotalCores();
-    int busyCores = scheduler->getBusyCores();
-    int availableCores = totalCores - busyCores;
-    double cpuUtilization = ((double)busyCores / totalCores) * 100.0;
-
-    logfile << "CPU utilization: " << std::fixed << std::setprecision(2) << cpuUtilization << "%\n";
-    logfile << "Cores used: " << busyCores << "\n";
-    logfile << "Cores available: " << availableCores << "\n";
+    writeCpuLoad(logfile, static_cast<int>(runningProcessesMap.size()), scheduler->getTotalCores(), true);
 
     logfile << "\n-------------------------------------------------------";
 
@@ -510,31 +895,9 @@ void MainConsole::reportUtil() {
     }
 
     // Display finished processes
-    if (!finishedProcesses.empty()) {
-        logfile << "\nFinished processes:\n";
-        for (Process* process : finishedProcesses) {
-            std::string processName = process->getName();
-            std::time_t creationTime = process->getCreationTime();
-            std::tm creationTm;
-
-            localtime_s(&creationTm, &creationTime);
-
-            char timeBuffer[30];
-            std::strftime(timeBuffer, sizeof(timeBuffer), "%m/%d/%Y %I:%M:%S%p", &creationTm);
-            std::string timeStr = timeBuffer;
+    displayFinishedProcesses(logfile, finishedProcesses);
 
-            int totalLines = process->getTotalLines();
-
-            // Format: processName  (creationTime)  Finished   totalLines / totalLines
-            logfile << std::left << std::setw(15) << processName
-                << "(" << timeStr << ")    "
-                << "Finished     "
-                << totalLines << " / " << totalLines << "\n";
-        }
-    }
-    else {
-        logfile << "\nNo finished processes.\n";
-    }
+    writeSchedulingSummary(logfile, finishedProcesses);
 
     logfile << "-------------------------------------------------------\n\n\n";
     logfile.close();
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <ostream>
 
 class ConsoleManager;
 class Process;
@@ -18,10 +19,14 @@ private:
 
     void displayProcessSmi();
     void displayVmStat();
+    void displayMemoryMap();
     void displayRunningProcesses(const std::vector<Process*>& runningProcesses, const std::map<Process*, int>& runningProcessesMap);
-    void displayFinishedProcesses(const std::vector<Process*>& finishedProcesses);
+    void displayFinishedProcesses(std::ostream& out, const std::vector<Process*>& finishedProcesses);
     void displayQueuedProcesses(const std::vector<Process*>& queuedProcesses);
 
+    // Windowed utilization and load averages; perCore adds a line for each core
+    void writeCpuLoad(std::ostream& out, int busyCores, int totalCores, bool perCore);
+    void writeSchedulingSummary(std::ostream& out, const std::vector<Process*>& finishedProcesses);
     void reportUtil();
 
     ConsoleManager& consoleManager;
@@ -0,0 +1,100 @@
+#include "MemoryBenchmark.h"
+#include "MemoryManager.h"
+#include "Process.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+static const unsigned int BENCH_MEMORY = 1u << 20;
+static const unsigned int BENCH_FRAME_SIZE = 256;
+static const unsigned int BENCH_PROCESS_SIZE = 64u * 1024;
+static const unsigned int BENCH_PROCESSES_PER_THREAD = 4;
+static const unsigned int BENCH_ACCESSES_PER_ROUND = 512;
+static const unsigned int BENCH_DURATION_MS = 500;
+
+static double runRound(unsigned int numThreads, unsigned long long& operations, unsigned int& faults) {
+    MemoryManager memoryManager;
+    memoryManager.initialize(BENCH_MEMORY, BENCH_FRAME_SIZE, "fifo", "first-fit", "paging", numThreads);
+
+    std::vector<std::unique_ptr<Process>> processes;
+    for (unsigned int i = 0; i < numThreads * BENCH_PROCESSES_PER_THREAD; ++i) {
+        processes.emplace_back(new Process("bench" + std::to_string(i)));
+        processes.back()->setMemorySize(BENCH_PROCESS_SIZE);
+    }
+
+    std::atomic<bool> start(false);
+    std::atomic<bool> stop(false);
+    std::atomic<unsigned long long> totalOperations(0);
+    std::vector<std::thread> threads;
+
+    for (unsigned int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t + 1);
+            std::uniform_int_distribution<unsigned int> address(0, BENCH_PROCESS_SIZE - 1);
+            unsigned long long localOperations = 0;
+            unsigned int next = 0;
+
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            while (!stop.load()) {
+                Process* process = processes[t * BENCH_PROCESSES_PER_THREAD + next].get();
+                next = (next + 1) % BENCH_PROCESSES_PER_THREAD;
+
+                memoryManager.allocateMemory(process, BENCH_PROCESS_SIZE);
+                for (unsigned int i = 0; i < BENCH_ACCESSES_PER_ROUND; ++i) {
+                    memoryManager.accessMemory(process, address(rng), false, static_cast<int>(t));
+                }
+                memoryManager.deallocateMemory(process, static_cast<int>(t));
+                localOperations += BENCH_ACCESSES_PER_ROUND + 2;
+            }
+            totalOperations += localOperations;
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(BENCH_DURATION_MS));
+    stop.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    operations = totalOperations.load();
+    faults = memoryManager.getNumPageFaults();
+    return operations / seconds;
+}
+
+int runMemoryBenchmark(unsigned int maxThreads, std::ostream& out) {
+    if (maxThreads == 0) {
+        maxThreads = 1;
+    }
+
+    out << "Memory benchmark: " << BENCH_MEMORY / BENCH_FRAME_SIZE << " frames, "
+        << BENCH_PROCESS_SIZE / BENCH_FRAME_SIZE << " pages per process, "
+        << BENCH_DURATION_MS << " ms per run\n";
+    out << std::setw(8) << "Threads" << std::setw(16) << "Ops/sec" << std::setw(12) << "Faults"
+        << std::setw(10) << "Speedup" << "\n";
+
+    double baseline = 0.0;
+    for (unsigned int threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        unsigned long long operations = 0;
+        unsigned int faults = 0;
+        double throughput = runRound(threads, operations, faults);
+        if (baseline == 0.0) {
+            baseline = throughput;
+        }
+        out << std::setw(8) << threads << std::setw(16) << std::fixed << std::setprecision(0) << throughput
+            << std::setw(12) << faults << std::setw(9) << std::setprecision(2) << throughput / baseline << "x\n";
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+    return 0;
+}
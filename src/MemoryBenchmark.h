@@ -0,0 +1,8 @@
+#pragma once
+
+#include <ostream>
+
+// Multi-threaded allocation benchmark for the paging MemoryManager: each
+// thread repeatedly admits a process, touches its pages at random and frees
+// it. Runs with 1, 2, 4, ... up to maxThreads threads and prints throughput.
+int runMemoryBenchmark(unsigned int maxThreads, std::ostream& out);
@@ -2,403 +2,2089 @@
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <thread>
+#include <climits>
+
+static const char* BACKING_STORE_FILE = "csopesy-backing-store.bin";
+// Flat mode has no frames; process images are swapped in chunks of this size
+static const unsigned int FLAT_SWAP_SLOT_SIZE = 256;
+// The swap file holds up to this many times physical memory
+static const unsigned int SWAP_TO_MEMORY_RATIO = 4;
+// Blocks slid per compaction cycle, which bounds the work done under the lock
+static const size_t COMPACTION_MOVES_PER_CYCLE = 4;
+// Flat memory counts as thrashing once this many processes were swapped out
+// within the window; admissions that need an eviction are refused until it passes
+static const size_t THRASH_EVICTIONS = 8;
+static const std::chrono::milliseconds THRASH_WINDOW(100);
+// Upper bound on frames moved between the global pool and a core's cache at once
+static const size_t MAX_FRAME_BATCH = 8;
 
 MemoryManager::MemoryManager()
-    : maxMemory(0), memPerFrame(0), totalFrames(0), flatMemory(true),
-    usedMemory(0), numPagedIn(0), numPagedOut(0),
-    idleCpuTicks(0), activeCpuTicks(0), totalCpuTicks(0) {}
+    : maxMemory(0), memPerFrame(0), totalFrames(0), memoryMode(MemoryMode::Flat), flatMemory(true),
+    contiguousUsed(0), nextUntouchedFrame(0), pageTableLevels(0), hugePageRatio(1), hugePageMinProcessMemory(0),
+    frameBatchSize(1), usedFrames(0), nextSegmentId(0), numCores(1), workingSetWindow(0), numPagedIn(0), numPagedOut(0),
+    numSwapFullWrites(0), numPageFaults(0), numMemoryAccesses(0), numEvictions(0), compactionThreshold(25), numCompactionCycles(0),
+    compactionBytesMoved(0), numProcessesReleased(0), numPrefetches(0), numThrottledAdmissions(0), numRefusedAdmissions(0),
+    numSuspensions(0), numReactivations(0), lastRefusedSize(0), numHugeMappings(0), numHugePromotions(0), numHugeDemotions(0),
+    numHugeFallbacks(0), baseAllocNs(0), baseAllocations(0), hugeAllocNs(0), hugeAllocations(0),
+    numForks(0), numPagesShared(0), numCopyOnWriteCopies(0), numCopyOnWriteReuses(0), idleCpuTicks(0), activeCpuTicks(0), totalCpuTicks(0) {}
+
+MemoryManager::~MemoryManager() {
+    // Requests in flight still reference this manager
+    swapEngine.stop();
+}
+
+void MemoryManager::initialize(unsigned int maxMem, unsigned int memPerFrame, const std::string& replacementPolicy,
+    const std::string& allocationPolicy, const std::string& memoryMode, unsigned int numCores) {
+    std::lock_guard<std::mutex> lock(memoryMutex);
+
+    maxMemory = maxMem;
+    this->memPerFrame = memPerFrame;
+    totalFrames = maxMemory / memPerFrame;
+    this->numCores = std::max(1u, numCores);
+    tlbs.clear();
+
+    if (memoryMode == "buddy") {
+        this->memoryMode = MemoryMode::Buddy;
+    }
+    else if (memoryMode == "flat" || (memoryMode != "paging" && maxMemory == memPerFrame)) {
+        this->memoryMode = MemoryMode::Flat;
+    }
+    else {
+        this->memoryMode = MemoryMode::Paging;
+    }
+    // Buddy memory is contiguous too and shares the flat code paths
+    flatMemory = (this->memoryMode != MemoryMode::Paging);
+
+    if (flatMemory) {
+        if (this->memoryMode == MemoryMode::Buddy) {
+            // mem-per-frame is the smallest block the buddy system hands out
+            BuddyAllocator* buddy = new BuddyAllocator();
+            buddy->initialize(maxMemory, memPerFrame < maxMemory ? memPerFrame : 1);
+            contiguousAllocator.reset(buddy);
+        }
+        else {
+            // Initialize single block of free memory
+            AllocationPolicy policy = AllocationPolicy::FirstFit;
+            FlatAllocator::parsePolicy(allocationPolicy, policy);
+            FlatAllocator* flat = new FlatAllocator();
+            flat->initialize(maxMemory, policy);
+            contiguousAllocator.reset(flat);
+        }
+        swapVictimPolicy.reset(SwapVictimPolicy::create("lru"));
+    }
+    else {
+        // Frame descriptors are materialized as frames are first handed out
+        frames.initialize(totalFrames);
+        freeFramePool.clear();
+        freeHugeFrames.clear();
+        nextUntouchedFrame = 0;
+        usedFrames = 0;
+
+        // One frame cache per core plus one for threads not on a core; batches
+        // stay small enough that the caches together hold at most a quarter of memory
+        frameCaches.clear();
+        for (unsigned int cache = 0; cache <= this->numCores; ++cache) {
+            frameCaches.emplace_back(new FrameCache());
+        }
+        frameBatchSize = std::max<size_t>(1, std::min<size_t>(MAX_FRAME_BATCH, totalFrames / (4 * frameCaches.size())));
+
+        this->replacementPolicy.reset(PageReplacementPolicy::create(replacementPolicy));
+    }
+    contiguousUsed = 0;
+
+    unsigned int slotSize = flatMemory ? std::min(FLAT_SWAP_SLOT_SIZE, maxMemory) : memPerFrame;
+    // Slot numbers are ints, which caps the swap file for tiny frames over huge memories
+    uint64_t numSlots = static_cast<uint64_t>(maxMemory / slotSize) * SWAP_TO_MEMORY_RATIO;
+    backingStore.open(BACKING_STORE_FILE, slotSize, static_cast<unsigned int>(std::min<uint64_t>(numSlots, INT_MAX)));
+}
+
+std::shared_ptr<ProcessPageTable> MemoryManager::findPageTable(Process* process) const {
+    std::lock_guard<std::mutex> lock(pageTablesMutex);
+    auto it = pageTables.find(process);
+    return it != pageTables.end() ? it->second : nullptr;
+}
+
+FrameCache& MemoryManager::frameCache(int coreId) {
+    // The dispatcher, console and background work use the last cache
+    if (coreId < 0) {
+        return *frameCaches.back();
+    }
+    return *frameCaches[static_cast<size_t>(coreId) % (frameCaches.size() - 1)];
+}
+
+int MemoryManager::acquireFrame(int coreId) {
+    FrameCache& cache = frameCache(coreId);
+    {
+        std::lock_guard<std::mutex> cacheLock(cache.mutex);
+        if (cache.frames.empty()) {
+            // Refill a batch from the global pool: returned frames first, then
+            // frames that were never used
+            std::lock_guard<std::mutex> poolLock(poolMutex);
+            while (cache.frames.size() < frameBatchSize && !freeFramePool.empty()) {
+                cache.frames.push_back(freeFramePool.back());
+                freeFramePool.pop_back();
+            }
+            while (cache.frames.size() < frameBatchSize && nextUntouchedFrame < totalFrames) {
+                cache.frames.push_back(static_cast<int>(nextUntouchedFrame++));
+            }
+            if (cache.frames.empty() && !freeHugeFrames.empty()) {
+                // Only whole huge frames are left; break one up
+                int head = freeHugeFrames.back();
+                freeHugeFrames.pop_back();
+                for (unsigned int offset = 0; offset < hugePageRatio; ++offset) {
+                    cache.frames.push_back(head + static_cast<int>(offset));
+                }
+            }
+        }
+        if (!cache.frames.empty()) {
+            int frameNumber = cache.frames.back();
+            cache.frames.pop_back();
+            return frameNumber;
+        }
+    }
+
+    // The pool is dry; take a frame another core is holding before evicting
+    for (auto& other : frameCaches) {
+        std::lock_guard<std::mutex> otherLock(other->mutex);
+        if (!other->frames.empty()) {
+            int frameNumber = other->frames.back();
+            other->frames.pop_back();
+            return frameNumber;
+        }
+    }
+    return -1;
+}
+
+void MemoryManager::releaseFrames(const std::vector<int>& frameNumbers, int coreId) {
+    FrameCache& cache = frameCache(coreId);
+    std::lock_guard<std::mutex> cacheLock(cache.mutex);
+    cache.frames.insert(cache.frames.end(), frameNumbers.begin(), frameNumbers.end());
+
+    // Hand a batch back once this core holds more than it will soon need
+    if (cache.frames.size() > 2 * frameBatchSize) {
+        std::lock_guard<std::mutex> poolLock(poolMutex);
+        while (cache.frames.size() > frameBatchSize) {
+            freeFramePool.push_back(cache.frames.back());
+            cache.frames.pop_back();
+        }
+    }
+}
+
+int MemoryManager::takeHugeFrame() {
+    std::lock_guard<std::mutex> poolLock(poolMutex);
+    if (!freeHugeFrames.empty()) {
+        int head = freeHugeFrames.back();
+        freeHugeFrames.pop_back();
+        return head;
+    }
+    // Carve one from never-used frames; those skipped to reach alignment become base frames
+    unsigned int head = (nextUntouchedFrame + hugePageRatio - 1) / hugePageRatio * hugePageRatio;
+    if (head >= totalFrames || totalFrames - head < hugePageRatio) {
+        return -1;
+    }
+    for (unsigned int frame = nextUntouchedFrame; frame < head; ++frame) {
+        freeFramePool.push_back(static_cast<int>(frame));
+    }
+    nextUntouchedFrame = head + hugePageRatio;
+    return static_cast<int>(head);
+}
+
+void MemoryManager::releaseHugeFrames(const std::vector<int>& headFrames) {
+    std::lock_guard<std::mutex> poolLock(poolMutex);
+    freeHugeFrames.insert(freeHugeFrames.end(), headFrames.begin(), headFrames.end());
+}
+
+HugeRegion* MemoryManager::findHugeRegion(ProcessPageTable& table, int pageNumber) const {
+    size_t index = static_cast<size_t>(pageNumber) / hugePageRatio;
+    return index < table.hugeRegions.size() ? &table.hugeRegions[index] : nullptr;
+}
+
+int MemoryManager::obtainFrame(int coreId) {
+    for (;;) {
+        // Only a take of a free frame is timed, as for huge frames; evictions are counted apart
+        auto allocationStart = std::chrono::steady_clock::now();
+        int frameNumber = acquireFrame(coreId);
+        if (frameNumber != -1) {
+            baseAllocNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - allocationStart).count();
+            baseAllocations++;
+        }
+        else {
+            // No free frame; the replacement policy picks a resident page to give up
+            frameNumber = evictVictim(coreId);
+        }
+        if (frameNumber != -1) {
+            return frameNumber;
+        }
+        // Every frame is in flight between other threads
+        std::this_thread::yield();
+    }
+}
+
+int MemoryManager::evictVictim(int coreId) {
+    int frameNumber;
+    Process* owner;
+    int pageNumber;
+    bool huge;
+    int segmentId;
+    std::vector<Process*> mappers;
+    {
+        std::lock_guard<std::mutex> policyLock(policyMutex);
+        frameNumber = replacementPolicy->selectVictim();
+        if (frameNumber == -1) {
+            return -1;
+        }
+        replacementPolicy->onFree(frameNumber);
+        // Claiming the frame keeps a concurrent deallocation from freeing it too
+        Frame& frame = frames[frameNumber];
+        frame.state = FrameState::Evicting;
+        owner = frame.owner;
+        pageNumber = frame.pageNumber;
+        huge = frame.huge;
+        segmentId = frame.segmentId;
+        frame.segmentId = -1;
+        // A shared frame leaves every page table that maps it
+        auto sharers = frameSharers.find(frameNumber);
+        if (sharers != frameSharers.end()) {
+            mappers.swap(sharers->second);
+            frameSharers.erase(sharers);
+        }
+        else if (segmentId == -1) {
+            mappers.push_back(owner);
+        }
+        frame.refCount = 0;
+    }
+
+    std::shared_ptr<SharedSegment> segment = segmentId != -1 ? findSegment(segmentId) : nullptr;
+    if (segment) {
+        std::lock_guard<std::mutex> segmentLock(segment->pages.mutex);
+        PageTableEntry* entry = segment->pages.released ? nullptr : segment->pages.entries.find(pageNumber);
+        if (entry != nullptr && entry->present && entry->frameNumber == frameNumber) {
+            // Every user may have the page cached, each at its own page number
+            for (const auto& user : segment->users) {
+                shootdownPage(user.first, user.second + pageNumber);
+            }
+            const auto& writer = segment->users.front();
+            pageOut(writer.first, *entry, writer.second + pageNumber);
+            entry->present = false;
+            entry->frameNumber = -1;
+            segment->pages.residentPages--;
+        }
+    }
+
+    // Only the victim's page tables are locked, one at a time; other processes keep running
+    for (Process* mapper : mappers) {
+        std::shared_ptr<ProcessPageTable> table = findPageTable(mapper);
+        if (!table) {
+            continue;
+        }
+        std::lock_guard<std::mutex> tableLock(table->mutex);
+        PageTableEntry* entry = table->released || huge ? nullptr : table->entries.find(pageNumber);
+        if (huge) {
+            evictHugeLocked(mapper, *table, frameNumber, pageNumber);
+        }
+        else if (entry != nullptr && entry->present && entry->frameNumber == frameNumber) {
+            // No core may keep using the translation once the page starts leaving
+            shootdownPage(mapper, pageNumber);
+            pageOut(mapper, *entry, pageNumber);
+            entry->present = false;
+            entry->frameNumber = -1;
+            entry->copyOnWrite = false;
+            table->residentPages--;
+            HugeRegion* region = findHugeRegion(*table, pageNumber);
+            if (region != nullptr) {
+                region->residentBasePages--;
+                if (entry->swapSlot != -1) {
+                    region->swappedBasePages++;
+                }
+            }
+        }
+    }
+
+    if (huge) {
+        // The caller needs one frame; the rest of the huge frame goes to this core's cache
+        std::vector<int> rest;
+        for (unsigned int offset = 1; offset < hugePageRatio; ++offset) {
+            rest.push_back(frameNumber + static_cast<int>(offset));
+        }
+        releaseFrames(rest, coreId);
+        usedFrames -= hugePageRatio;
+    }
+    else {
+        usedFrames--;
+    }
+    numPagedOut++;
+    return frameNumber;
+}
+
+void MemoryManager::evictHugeLocked(Process* owner, ProcessPageTable& table, int frameNumber, int pageNumber) {
+    HugeRegion* region = table.released ? nullptr : findHugeRegion(table, pageNumber);
+    if (region == nullptr || region->frameNumber != frameNumber) {
+        return;
+    }
+    // Demoted: the pages leave as base pages and come back one at a time
+    shootdownPage(owner, pageNumber, true);
+    for (unsigned int offset = 0; offset < hugePageRatio; ++offset) {
+        int page = pageNumber + static_cast<int>(offset);
+        PageTableEntry& entry = table.entries.at(page);
+        pageOut(owner, entry, page);
+        if (entry.swapSlot != -1) {
+            region->swappedBasePages++;
+        }
+    }
+    region->frameNumber = -1;
+    table.residentPages -= hugePageRatio;
+    numHugeMappings--;
+    numHugeDemotions++;
+}
+
+void MemoryManager::pageOut(Process* process, PageTableEntry& entry, int pageNumber) {
+    std::lock_guard<std::mutex> swapLock(swapMutex);
+    // With the swap area full the words are not extracted, so they stay with
+    // the process and the page still reads back; only the count shows it
+    if (!backingStore.hasFreeSlot()) {
+        numSwapFullWrites++;
+        return;
+    }
+    // Pages that were never written have nothing to save
+    std::vector<char> page;
+    if (!process->extractMemory(pageNumber * memPerFrame, memPerFrame, page)) {
+        return;
+    }
+
+    int slot = backingStore.allocateSlot();
+    if (!backingStore.writeSlot(slot, page)) {
+        backingStore.freeSlot(slot);
+        process->restoreMemory(pageNumber * memPerFrame, page);
+        return;
+    }
+    entry.swapSlot = slot;
+}
+
+void MemoryManager::pageIn(Process* process, PageTableEntry& entry, int pageNumber) {
+    if (entry.swapSlot == -1) {
+        return;
+    }
+    std::lock_guard<std::mutex> swapLock(swapMutex);
+    std::vector<char> page;
+    if (backingStore.readSlot(entry.swapSlot, page)) {
+        process->restoreMemory(pageNumber * memPerFrame, page);
+    }
+    backingStore.freeSlot(entry.swapSlot);
+    entry.swapSlot = -1;
+}
+
+void MemoryManager::swapOutImage(Process* process, unsigned int size) {
+    std::lock_guard<std::mutex> swapLock(swapMutex);
+    unsigned int slotSize = backingStore.getSlotSize();
+    std::vector<std::pair<unsigned int, int>>& chunks = swappedImages[process];
+
+    // Chunks never written have nothing to save
+    std::map<unsigned int, std::vector<char>> images;
+    process->extractMemoryChunks(size, slotSize, images);
+    for (const auto& image : images) {
+        int slot = backingStore.hasFreeSlot() ? backingStore.allocateSlot() : -1;
+        if (slot != -1 && backingStore.writeSlot(slot, image.second)) {
+            chunks.emplace_back(image.first, slot);
+        }
+        else {
+            // Without a slot the words stay in memory
+            if (slot != -1) {
+                backingStore.freeSlot(slot);
+            }
+            else {
+                numSwapFullWrites++;
+            }
+            process->restoreMemory(image.first, image.second);
+        }
+    }
+}
+
+void MemoryManager::swapInImage(Process* process) {
+    std::lock_guard<std::mutex> swapLock(swapMutex);
+    auto it = swappedImages.find(process);
+    if (it == swappedImages.end()) {
+        return;
+    }
+    for (const auto& chunk : it->second) {
+        std::vector<char> bytes;
+        if (backingStore.readSlot(chunk.second, bytes)) {
+            process->restoreMemory(chunk.first, bytes);
+        }
+        backingStore.freeSlot(chunk.second);
+    }
+    swappedImages.erase(it);
+}
+
+void MemoryManager::completeSwapIn(Process* process, unsigned int size) {
+    {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        if (pendingSwapIns.erase(process) == 0) {
+            return;
+        }
+        swapVictimPolicy->onAdmit(process, size);
+        process->setInMemory(true);
+    }
+    std::lock_guard<std::mutex> listenerLock(swapInListenerMutex);
+    if (swapInListener) {
+        swapInListener(process);
+    }
+}
+
+void MemoryManager::releaseSwap(Process* process) {
+    std::lock_guard<std::mutex> swapLock(swapMutex);
+    auto imageIt = swappedImages.find(process);
+    if (imageIt != swappedImages.end()) {
+        for (const auto& chunk : imageIt->second) {
+            backingStore.freeSlot(chunk.second);
+        }
+        swappedImages.erase(imageIt);
+    }
+}
+
+bool MemoryManager::accessMemory(Process* process, unsigned int address, bool write, int coreId) {
+    if (flatMemory) {
+        // The whole process is resident while it is in memory
+        numMemoryAccesses++;
+        return true;
+    }
+    if (workingSetWindow > 0) {
+        process->getWorkingSet().reference(address / memPerFrame);
+    }
+    std::unique_lock<std::mutex> tlbLock;
+    if (lookupTlb(process, address, write, coreId, tlbLock)) {
+        return true;
+    }
+    std::shared_ptr<ProcessPageTable> table;
+    std::unique_lock<std::mutex> tableLock;
+    return faultIn(process, address, write, coreId, table, tableLock);
+}
+
+uint16_t MemoryManager::readMemory(Process* process, unsigned int address, int coreId) {
+    if (flatMemory) {
+        // Serialized with swapping so the word cannot move to the backing store mid-read
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        numMemoryAccesses++;
+        return process->readWord(address);
+    }
+    if (workingSetWindow > 0) {
+        process->getWorkingSet().reference(address / memPerFrame);
+    }
+    std::unique_lock<std::mutex> tlbLock;
+    if (lookupTlb(process, address, false, coreId, tlbLock)) {
+        return process->readWord(address);
+    }
+    std::shared_ptr<ProcessPageTable> table;
+    std::unique_lock<std::mutex> tableLock;
+    faultIn(process, address, false, coreId, table, tableLock);
+    return process->readWord(address);
+}
+
+void MemoryManager::writeMemory(Process* process, unsigned int address, uint16_t value, int coreId) {
+    if (flatMemory) {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        numMemoryAccesses++;
+        process->writeWord(address, value);
+        return;
+    }
+    if (workingSetWindow > 0) {
+        process->getWorkingSet().reference(address / memPerFrame);
+    }
+    std::unique_lock<std::mutex> tlbLock;
+    if (lookupTlb(process, address, true, coreId, tlbLock)) {
+        process->writeWord(address, value);
+        return;
+    }
+    std::shared_ptr<ProcessPageTable> table;
+    std::unique_lock<std::mutex> tableLock;
+    faultIn(process, address, true, coreId, table, tableLock);
+    process->writeWord(address, value);
+}
+
+Tlb* MemoryManager::coreTlb(int coreId) const {
+    if (coreId < 0 || tlbs.empty()) {
+        return nullptr;
+    }
+    return tlbs[static_cast<size_t>(coreId) % tlbs.size()].get();
+}
+
+bool MemoryManager::lookupTlb(Process* process, unsigned int address, bool write, int coreId,
+    std::unique_lock<std::mutex>& tlbLock) {
+    Tlb* tlb = coreTlb(coreId);
+    // Out-of-range addresses wrap around the page table, which only the slow path knows
+    if (tlb == nullptr || address >= process->getMemorySize()) {
+        return false;
+    }
+    tlbLock = std::unique_lock<std::mutex>(tlb->getMutex());
+    int frameNumber;
+    if (!tlb->lookup(process->getId(), static_cast<int>(address / memPerFrame), frameNumber, write)) {
+        tlbLock.unlock();
+        return false;
+    }
+
+    numMemoryAccesses++;
+    if (replacementPolicy->tracksAccesses()) {
+        // The frame may already be claimed by an eviction waiting on this TLB
+        std::lock_guard<std::mutex> policyLock(policyMutex);
+        if (frames[frameNumber].state == FrameState::Mapped) {
+            replacementPolicy->onAccess(frameNumber);
+        }
+    }
+    return true;
+}
+
+void MemoryManager::shootdownPage(Process* process, int pageNumber, bool huge) {
+    for (auto& tlb : tlbs) {
+        std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+        tlb->shootdown(process->getId(), pageNumber, huge);
+    }
+}
+
+bool MemoryManager::faultIn(Process* process, unsigned int address, bool write, int coreId,
+    std::shared_ptr<ProcessPageTable>& table, std::unique_lock<std::mutex>& tableLock) {
+    numMemoryAccesses++;
+
+    // Only the core running the process faults for it, so its own pointer is current
+    table = process->getPageTable();
+    if (!table) {
+        return false;
+    }
+    tableLock = std::unique_lock<std::mutex>(table->mutex);
+    if (table->released || table->entries.size() == 0) {
+        return false;
+    }
+
+    int pageNumber = static_cast<int>((address / memPerFrame) % table->entries.size());
+    Tlb* tlb = coreTlb(coreId);
+    // A size that is not a whole number of pages leaves a partial private page above the segment
+    if (table->segment && pageNumber >= table->segmentFirstPage
+        && static_cast<unsigned int>(pageNumber - table->segmentFirstPage) < table->segment->size / memPerFrame) {
+        return faultInSegment(process, pageNumber, coreId, tlb, table, tableLock);
+    }
+    HugeRegion* region = findHugeRegion(*table, pageNumber);
+    if (region != nullptr && region->frameNumber != -1) {
+        if (tlb != nullptr) {
+            std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+            tlb->insert(process->getId(), pageNumber, region->frameNumber, true);
+        }
+        if (replacementPolicy->tracksAccesses()) {
+            std::lock_guard<std::mutex> policyLock(policyMutex);
+            replacementPolicy->onAccess(region->frameNumber);
+        }
+        return true;
+    }
+    // A region none of whose pages are in or out is backed by one huge frame if there is one
+    bool untouchedRegion = region != nullptr && region->residentBasePages + region->swappedBasePages == 0;
+    if (untouchedRegion) {
+        numPageFaults++;
+        if (faultInHuge(process, pageNumber, *table, *region, tlb)) {
+            return false;
+        }
+    }
+
+    PageTableEntry& entry = table->entries.at(pageNumber);
+    if (entry.present) {
+        if (write && entry.copyOnWrite) {
+            return breakCopyOnWrite(process, pageNumber, *table, entry, coreId, tlb, tableLock);
+        }
+        if (tlb != nullptr) {
+            std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+            tlb->insert(process->getId(), pageNumber, entry.frameNumber, false, !entry.copyOnWrite);
+        }
+        if (replacementPolicy->tracksAccesses()) {
+            std::lock_guard<std::mutex> policyLock(policyMutex);
+            replacementPolicy->onAccess(entry.frameNumber);
+        }
+        return true;
+    }
+
+    if (!untouchedRegion) {
+        numPageFaults++;
+    }
+
+    // Finding a frame may evict from another process; don't hold this table meanwhile
+    tableLock.unlock();
+    int frameNumber = obtainFrame(coreId);
+    tableLock.lock();
+
+    if (table->released || entry.present || (region != nullptr && region->frameNumber != -1)) {
+        // Deallocated, or another thread loaded the page or its whole region first
+        releaseFrames(std::vector<int>(1, frameNumber), coreId);
+        return false;
+    }
+
+    Frame& frame = frames[frameNumber];
+    frame.owner = process;
+    frame.pageNumber = pageNumber;
+    frame.huge = false;
+    frame.refCount = 1;
+    entry.frameNumber = frameNumber;
+    entry.present = true;
+    entry.copyOnWrite = false;
+    table->residentPages++;
+    usedFrames++;
+    if (region != nullptr) {
+        if (entry.swapSlot != -1) {
+            region->swappedBasePages--;
+        }
+        if (++region->residentBasePages == hugePageRatio) {
+            // Every page of the region is in; background promotion can collapse it
+            std::lock_guard<std::mutex> promotionLock(promotionMutex);
+            promotionCandidates.emplace_back(process, static_cast<unsigned int>(pageNumber) / hugePageRatio);
+        }
+    }
+    pageIn(process, entry, pageNumber);
+    if (tlb != nullptr) {
+        std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+        tlb->insert(process->getId(), pageNumber, frameNumber);
+    }
+
+    {
+        std::lock_guard<std::mutex> policyLock(policyMutex);
+        frame.state = FrameState::Mapped;
+        replacementPolicy->onLoad(frameNumber);
+    }
+    numPagedIn++;
+    return false;
+}
+
+bool MemoryManager::faultInSegment(Process* process, int pageNumber, int coreId, Tlb* tlb,
+    std::shared_ptr<ProcessPageTable>& table, std::unique_lock<std::mutex>& tableLock) {
+    // The segment outlives the fault: it is only freed once this process detaches
+    std::shared_ptr<SharedSegment> segment = table->segment;
+    int segmentPage = pageNumber - table->segmentFirstPage;
+    tableLock.unlock();
+    table = std::shared_ptr<ProcessPageTable>(segment, &segment->pages);
+    tableLock = std::unique_lock<std::mutex>(table->mutex);
+    if (table->released) {
+        return false;
+    }
+
+    PageTableEntry& entry = table->entries.at(segmentPage);
+    if (entry.present) {
+        if (tlb != nullptr) {
+            std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+            tlb->insert(process->getId(), pageNumber, entry.frameNumber);
+        }
+        if (replacementPolicy->tracksAccesses()) {
+            std::lock_guard<std::mutex> policyLock(policyMutex);
+            replacementPolicy->onAccess(entry.frameNumber);
+        }
+        return true;
+    }
+
+    numPageFaults++;
+    tableLock.unlock();
+    int frameNumber = obtainFrame(coreId);
+    tableLock.lock();
+
+    if (table->released || entry.present) {
+        // Another user loaded the page first
+        releaseFrames(std::vector<int>(1, frameNumber), coreId);
+        return false;
+    }
+
+    Frame& frame = frames[frameNumber];
+    frame.owner = nullptr;
+    frame.pageNumber = segmentPage;
+    frame.huge = false;
+    frame.refCount = 1;
+    frame.segmentId = segment->id;
+    entry.frameNumber = frameNumber;
+    entry.present = true;
+    table->residentPages++;
+    usedFrames++;
+    // The process's words for the segment range are the segment's words
+    pageIn(process, entry, pageNumber);
+    if (tlb != nullptr) {
+        std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+        tlb->insert(process->getId(), pageNumber, frameNumber);
+    }
+
+    {
+        std::lock_guard<std::mutex> policyLock(policyMutex);
+        frame.state = FrameState::Mapped;
+        replacementPolicy->onLoad(frameNumber);
+    }
+    numPagedIn++;
+    return false;
+}
+
+std::shared_ptr<SharedSegment> MemoryManager::findSegment(int id) const {
+    std::lock_guard<std::mutex> lock(segmentsMutex);
+    auto it = segmentsById.find(id);
+    return it != segmentsById.end() ? it->second : nullptr;
+}
+
+bool MemoryManager::attachSharedSegment(Process* process, const std::string& name, unsigned int size) {
+    if (flatMemory || size == 0 || memPerFrame == 0) {
+        return false;
+    }
+    unsigned int segmentSize = (size + memPerFrame - 1) / memPerFrame * memPerFrame;
+    std::lock_guard<std::mutex> lock(segmentsMutex);
+    std::shared_ptr<SharedSegment>& segment = segmentsByName[name];
+    bool created = !segment;
+    if (created) {
+        segment = std::make_shared<SharedSegment>();
+        segment->id = nextSegmentId++;
+        segment->name = name;
+        segment->size = segmentSize;
+        segment->pages.entries.initialize(segmentSize / memPerFrame, pageTableLevels);
+        segment->words = std::make_shared<SharedMemoryWords>();
+    }
+    if (segment->size == segmentSize && mapSegmentLocked(process, segment)) {
+        if (created) {
+            segmentsById[segment->id] = segment;
+        }
+        return true;
+    }
+    if (created) {
+        segmentsByName.erase(name);
+    }
+    return false;
+}
+
+bool MemoryManager::mapSegmentLocked(Process* process, const std::shared_ptr<SharedSegment>& segment) {
+    // The segment takes the top pages; page 0 holds the symbol table and stays private
+    unsigned int memorySize = process->getMemorySize();
+    if (memorySize < segment->size + memPerFrame) {
+        return false;
+    }
+    int firstPage = static_cast<int>((memorySize - segment->size) / memPerFrame);
+    std::shared_ptr<ProcessPageTable> table = findPageTable(process);
+    if (!table) {
+        return false;
+    }
+    std::lock_guard<std::mutex> tableLock(table->mutex);
+    if (table->released || table->segment) {
+        return false;
+    }
+    // Huge regions reaching into the segment go back to base pages; none is mapped before the first run
+    size_t privateRegions = hugePageRatio > 1 ? static_cast<size_t>(firstPage) / hugePageRatio : 0;
+    for (size_t index = privateRegions; index < table->hugeRegions.size(); ++index) {
+        if (table->hugeRegions[index].frameNumber != -1) {
+            return false;
+        }
+    }
+    if (table->hugeRegions.size() > privateRegions) {
+        table->hugeRegions.resize(privateRegions);
+    }
+
+    std::lock_guard<std::mutex> segmentLock(segment->pages.mutex);
+    if (segment->pages.released) {
+        return false;
+    }
+    segment->users.emplace_back(process, firstPage);
+    table->segment = segment;
+    table->segmentFirstPage = firstPage;
+    process->mapSharedMemory(segment->words, static_cast<unsigned int>(firstPage) * memPerFrame, segment->size);
+    return true;
+}
+
+void MemoryManager::detachSegment(Process* process, const std::shared_ptr<SharedSegment>& segment) {
+    std::lock_guard<std::mutex> lock(segmentsMutex);
+    std::lock_guard<std::mutex> segmentLock(segment->pages.mutex);
+    auto user = std::find_if(segment->users.begin(), segment->users.end(),
+        [process](const std::pair<Process*, int>& entry) { return entry.first == process; });
+    if (user != segment->users.end()) {
+        segment->users.erase(user);
+    }
+    if (!segment->users.empty() || segment->pages.released) {
+        return;
+    }
+
+    // The last user is gone; the segment's frames and swap slots go with it
+    segment->pages.released = true;
+    std::vector<int> freedFrames;
+    {
+        std::lock_guard<std::mutex> policyLock(policyMutex);
+        segment->pages.entries.forEachEntry([&](unsigned int, PageTableEntry& entry) {
+            if (!entry.present) {
+                return;
+            }
+            // A frame claimed by an evicting thread is that thread's to reuse
+            Frame& frame = frames[entry.frameNumber];
+            if (frame.state == FrameState::Mapped && frame.segmentId == segment->id) {
+                frame.state = FrameState::Free;
+                frame.refCount = 0;
+                frame.segmentId = -1;
+                replacementPolicy->onFree(entry.frameNumber);
+                freedFrames.push_back(entry.frameNumber);
+            }
+            entry.present = false;
+            entry.frameNumber = -1;
+        });
+    }
+    if (!freedFrames.empty()) {
+        usedFrames -= static_cast<unsigned int>(freedFrames.size());
+        releaseFrames(freedFrames, -1);
+    }
+    {
+        std::lock_guard<std::mutex> swapLock(swapMutex);
+        segment->pages.entries.forEachEntry([&](unsigned int, PageTableEntry& entry) {
+            if (entry.swapSlot != -1) {
+                backingStore.freeSlot(entry.swapSlot);
+                entry.swapSlot = -1;
+            }
+        });
+    }
+    segment->pages.residentPages = 0;
+    segmentsByName.erase(segment->name);
+    segmentsById.erase(segment->id);
+}
+
+bool MemoryManager::faultInHuge(Process* process, int pageNumber, ProcessPageTable& table, HugeRegion& region,
+    Tlb* tlb) {
+    // Huge frames are only taken when free; evicting for one would cost a whole region
+    auto allocationStart = std::chrono::steady_clock::now();
+    int head = takeHugeFrame();
+    if (head == -1) {
+        numHugeFallbacks++;
+        return false;
+    }
+    hugeAllocNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - allocationStart).count();
+    hugeAllocations++;
+
+    Frame& frame = frames[head];
+    frame.owner = process;
+    frame.pageNumber = pageNumber - pageNumber % static_cast<int>(hugePageRatio);
+    frame.huge = true;
+    frame.refCount = 1;
+    region.frameNumber = head;
+    table.residentPages += hugePageRatio;
+    usedFrames += hugePageRatio;
+    numHugeMappings++;
+    if (tlb != nullptr) {
+        std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+        tlb->insert(process->getId(), pageNumber, head, true);
+    }
+
+    {
+        std::lock_guard<std::mutex> policyLock(policyMutex);
+        frame.state = FrameState::Mapped;
+        replacementPolicy->onLoad(head);
+    }
+    numPagedIn++;
+    return true;
+}
+
+bool MemoryManager::breakCopyOnWrite(Process* process, int pageNumber, ProcessPageTable& table, PageTableEntry& entry,
+    int coreId, Tlb* tlb, std::unique_lock<std::mutex>& tableLock) {
+    int sharedFrame = entry.frameNumber;
+    auto keepFrame = [&]() {
+        // The other sharers copied the page or exited; it is writable in place
+        entry.copyOnWrite = false;
+        numCopyOnWriteReuses++;
+        if (tlb != nullptr) {
+            std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+            tlb->insert(process->getId(), pageNumber, sharedFrame);
+        }
+        return true;
+    };
+
+    bool shared;
+    {
+        std::lock_guard<std::mutex> policyLock(policyMutex);
+        shared = frames[sharedFrame].state != FrameState::Mapped || frames[sharedFrame].refCount > 1;
+    }
+    if (!shared) {
+        return keepFrame();
+    }
+
+    // Finding a frame may evict from another process; don't hold this table meanwhile
+    tableLock.unlock();
+    int frameNumber = obtainFrame(coreId);
+    tableLock.lock();
+
+    if (table.released || !entry.present || entry.frameNumber != sharedFrame) {
+        // Deallocated, or the shared page was evicted meanwhile
+        releaseFrames(std::vector<int>(1, frameNumber), coreId);
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> policyLock(policyMutex);
+        Frame& old = frames[sharedFrame];
+        shared = old.state != FrameState::Mapped || old.refCount > 1;
+        // An evicting thread that claimed the frame will find this page remapped and skip it
+        if (shared && old.state == FrameState::Mapped) {
+            unshareFrameLocked(sharedFrame, process);
+        }
+    }
+    if (!shared) {
+        releaseFrames(std::vector<int>(1, frameNumber), coreId);
+        return keepFrame();
+    }
+
+    // Other cores may still hold the read-only translation
+    shootdownPage(process, pageNumber);
+    Frame& frame = frames[frameNumber];
+    frame.owner = process;
+    frame.pageNumber = pageNumber;
+    frame.huge = false;
+    frame.refCount = 1;
+    entry.frameNumber = frameNumber;
+    entry.copyOnWrite = false;
+    usedFrames++;
+    numCopyOnWriteCopies++;
+    if (tlb != nullptr) {
+        std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+        tlb->insert(process->getId(), pageNumber, frameNumber);
+    }
+
+    std::lock_guard<std::mutex> policyLock(policyMutex);
+    frame.state = FrameState::Mapped;
+    replacementPolicy->onLoad(frameNumber);
+    return false;
+}
+
+void MemoryManager::shareFrameLocked(int frameNumber, Process* process) {
+    Frame& frame = frames[frameNumber];
+    std::vector<Process*>& sharers = frameSharers[frameNumber];
+    if (sharers.empty()) {
+        sharers.push_back(frame.owner);
+    }
+    sharers.push_back(process);
+    frame.refCount++;
+}
+
+bool MemoryManager::unshareFrameLocked(int frameNumber, Process* process) {
+    Frame& frame = frames[frameNumber];
+    auto sharers = frameSharers.find(frameNumber);
+    if (frame.refCount < 2 || sharers == frameSharers.end()) {
+        return false;
+    }
+    auto position = std::find(sharers->second.begin(), sharers->second.end(), process);
+    if (position == sharers->second.end()) {
+        return false;
+    }
+    sharers->second.erase(position);
+    frame.refCount--;
+    // The owner is who an eviction unmaps the frame from, so it must still map it
+    if (frame.owner == process) {
+        frame.owner = sharers->second.front();
+    }
+    if (frame.refCount == 1) {
+        frameSharers.erase(sharers);
+    }
+    return true;
+}
+
+void MemoryManager::promoteHugePage() {
+    std::pair<Process*, unsigned int> candidate;
+    {
+        std::lock_guard<std::mutex> promotionLock(promotionMutex);
+        if (promotionCandidates.empty()) {
+            return;
+        }
+        candidate = promotionCandidates.front();
+        promotionCandidates.pop_front();
+    }
+    Process* process = candidate.first;
+    std::shared_ptr<ProcessPageTable> table = findPageTable(process);
+    if (!table) {
+        return;
+    }
+    std::lock_guard<std::mutex> tableLock(table->mutex);
+    if (table->released || candidate.second >= table->hugeRegions.size()) {
+        return;
+    }
+    HugeRegion& region = table->hugeRegions[candidate.second];
+    if (region.frameNumber != -1 || region.residentBasePages != hugePageRatio) {
+        return;
+    }
+    int head = takeHugeFrame();
+    if (head == -1) {
+        // Try again on a later cycle
+        std::lock_guard<std::mutex> promotionLock(promotionMutex);
+        promotionCandidates.push_back(candidate);
+        return;
+    }
+
+    int firstPage = static_cast<int>(candidate.second * hugePageRatio);
+    for (auto& tlb : tlbs) {
+        std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+        for (unsigned int offset = 0; offset < hugePageRatio; ++offset) {
+            tlb->shootdown(process->getId(), firstPage + static_cast<int>(offset));
+        }
+    }
+
+    std::vector<int> baseFrames;
+    bool claimable = true;
+    {
+        std::lock_guard<std::mutex> policyLock(policyMutex);
+        // A page already claimed by an eviction stays with it; the region waits
+        // until that page comes back
+        for (unsigned int offset = 0; offset < hugePageRatio && claimable; ++offset) {
+            PageTableEntry* entry = table->entries.find(firstPage + static_cast<int>(offset));
+            // Shared frames stay with their other mappers
+            claimable = entry != nullptr && entry->present && frames[entry->frameNumber].state == FrameState::Mapped
+                && frames[entry->frameNumber].refCount == 1;
+        }
+        if (claimable) {
+            for (unsigned int offset = 0; offset < hugePageRatio; ++offset) {
+                PageTableEntry& entry = *table->entries.find(firstPage + static_cast<int>(offset));
+                frames[entry.frameNumber].state = FrameState::Free;
+                frames[entry.frameNumber].refCount = 0;
+                replacementPolicy->onFree(entry.frameNumber);
+                baseFrames.push_back(entry.frameNumber);
+                entry.present = false;
+                entry.frameNumber = -1;
+            }
+            Frame& frame = frames[head];
+            frame.owner = process;
+            frame.pageNumber = firstPage;
+            frame.huge = true;
+            frame.refCount = 1;
+            frame.state = FrameState::Mapped;
+            replacementPolicy->onLoad(head);
+        }
+    }
+    if (!claimable) {
+        releaseHugeFrames(std::vector<int>(1, head));
+        return;
+    }
+    region.frameNumber = head;
+    region.residentBasePages = 0;
+    numHugeMappings++;
+    numHugePromotions++;
+    releaseFrames(baseFrames, -1);
+}
+
+bool MemoryManager::admitLocked(Process* process, unsigned int size, bool allowEviction) {
+    // Compact while the free total would fit the block; evict only after that
+    while (!contiguousAllocator->allocate(process, size)) {
+        if (contiguousAllocator->getCapacity() - contiguousAllocator->getUsed() >= size && compactLocked()) {
+            continue;
+        }
+        if (!allowEviction) {
+            return false;
+        }
+        if (isThrashingLocked()) {
+            // Load control: while swap-outs come this fast, admitting one more
+            // process would only push out another that will want back in
+            numThrottledAdmissions++;
+            return false;
+        }
+
+        // Ask for the shortfall; if the free total already covers it, a hole
+        // of the full size is what is missing
+        size_t freeBytes = contiguousAllocator->getCapacity() - contiguousAllocator->getUsed();
+        size_t bytesNeeded = freeBytes < size ? size - freeBytes : size;
+        std::vector<Process*> victims = swapVictimPolicy->selectVictims(bytesNeeded);
+        if (victims.empty()) {
+            return false;
+        }
+        for (Process* victim : victims) {
+            swapOutProcess(victim);
+        }
+    }
+    contiguousUsed = contiguousAllocator->getUsed();
+    bool swappedOut = swappedOutProcesses.erase(process) > 0;
+    if (swappedOut && swapEngine.isAsync()) {
+        // The block is held for the image, but the process is only in memory
+        // (and a swap victim candidate) once the image has arrived
+        pendingSwapIns.insert(process);
+        swapEngine.submit(process, SwapDirection::In, size, [this, process, size]() {
+            swapInImage(process);
+            completeSwapIn(process, size);
+        });
+        return true;
+    }
+    swapVictimPolicy->onAdmit(process, size);
+    process->setInMemory(true);
+    if (swappedOut) {
+        swapEngine.submit(process, SwapDirection::In, size, [this, process]() { swapInImage(process); });
+    }
+    return true;
+}
+
+bool MemoryManager::isThrashingLocked() {
+    auto now = std::chrono::steady_clock::now();
+    while (!recentEvictions.empty() && now - recentEvictions.front() > THRASH_WINDOW) {
+        recentEvictions.pop_front();
+    }
+    return recentEvictions.size() >= THRASH_EVICTIONS;
+}
+
+bool MemoryManager::prefetchMemory(Process* process) {
+    if (!flatMemory) {
+        // Paging admits every process at once; pages come in on demand
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(memoryMutex);
+    if (process->isInMemory() || pendingSwapIns.count(process) > 0) {
+        return true;
+    }
+    // Only into space that is already free; prefetching never evicts
+    if (!admitLocked(process, process->getMemorySize(), false)) {
+        return false;
+    }
+    numPrefetches++;
+    return true;
+}
+
+void MemoryManager::swapOutProcess(Process* victim) {
+    swapVictimPolicy->onRemove(victim);
+    numEvictions++;
+    recentEvictions.push_back(std::chrono::steady_clock::now());
+
+    contiguousAllocator->release(victim);
+    contiguousUsed = contiguousAllocator->getUsed();
+
+    // Mark process as swapped out; its memory contents go to the backing store
+    swappedOutProcesses.insert(victim);
+    victim->setInMemory(false);
+    unsigned int size = victim->getMemorySize();
+    // Without I/O threads this waits out the device under memoryMutex on
+    // purpose: synchronous swapping is the baseline the I/O threads improve on
+    swapEngine.submit(victim, SwapDirection::Out, size, [this, victim, size]() { swapOutImage(victim, size); });
+}
+
+bool MemoryManager::allocateMemory(Process* process, unsigned int size) {
+    if (size > maxMemory) {
+        return false;
+    }
+
+    if (flatMemory) {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        if (pendingSwapIns.count(process) > 0) {
+            // Its image is still on the way in
+            return false;
+        }
+        if (!admitLocked(process, size, true)) {
+            numRefusedAdmissions++;
+            lastRefusedSize = size;
+            return false;
+        }
+        return process->isInMemory();
+    }
+    else {
+        // Demand paging: only the page table is set up here; every page starts
+        // non-present and gets a frame on its first access. A process suspended
+        // by load control keeps its table.
+        if (!findPageTable(process)) {
+            unsigned int numPages = (size + memPerFrame - 1) / memPerFrame;
+            std::shared_ptr<ProcessPageTable> table = std::make_shared<ProcessPageTable>();
+            table->entries.initialize(numPages, pageTableLevels);
+            if (hugePageRatio > 1 && size >= hugePageMinProcessMemory) {
+                // Only whole regions can be huge; a partial last region stays base pages
+                table->hugeRegions.resize(numPages / hugePageRatio);
+            }
+            process->getWorkingSet().setWindow(workingSetWindow);
+            process->setPageTable(table);
+            {
+                std::lock_guard<std::mutex> lock(pageTablesMutex);
+                pageTables[process] = table;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(memoryMutex, std::defer_lock);
+        if (workingSetWindow > 0) {
+            // Marked in memory under the lock, so load control cannot suspend it in between
+            lock.lock();
+            if (std::find(activeProcesses.begin(), activeProcesses.end(), process) == activeProcesses.end()) {
+                if (!admitWorkingSetLocked(process)) {
+                    // Admitting it would only have the active processes take turns faulting
+                    swappedOutProcesses.insert(process);
+                    process->setInMemory(false);
+                    numThrottledAdmissions++;
+                    return false;
+                }
+                if (swappedOutProcesses.erase(process) > 0) {
+                    numReactivations++;
+                }
+                activeProcesses.push_back(process);
+            }
+        }
+        process->setInMemory(true);
+        return true;
+    }
+}
+
+void MemoryManager::deallocateMemory(Process* process, int coreId) {
+    if (flatMemory) {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        releaseSwap(process);
+        contiguousAllocator->release(process);
+        contiguousUsed = contiguousAllocator->getUsed();
+        swapVictimPolicy->onRemove(process);
+        swappedOutProcesses.erase(process);
+        pendingSwapIns.erase(process);
+        process->setInMemory(false);
+        numProcessesReleased++;
+        return;
+    }
+
+    if (workingSetWindow > 0) {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        swappedOutProcesses.erase(process);
+        activeProcesses.erase(std::remove(activeProcesses.begin(), activeProcesses.end(), process), activeProcesses.end());
+    }
+
+    std::shared_ptr<ProcessPageTable> table;
+    {
+        std::lock_guard<std::mutex> lock(pageTablesMutex);
+        auto it = pageTables.find(process);
+        if (it != pageTables.end()) {
+            table = it->second;
+            pageTables.erase(it);
+        }
+    }
+
+    std::shared_ptr<SharedSegment> segment;
+    if (table) {
+        std::lock_guard<std::mutex> tableLock(table->mutex);
+        table->released = true;
+        segment.swap(table->segment);
+        for (auto& tlb : tlbs) {
+            std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+            tlb->invalidateAddressSpace(process->getId());
+        }
+
+        // One pass under each lock rather than a lock round trip per page
+        std::vector<int> freedFrames;
+        std::vector<int> freedHugeFrames;
+        {
+            std::lock_guard<std::mutex> policyLock(policyMutex);
+            table->entries.forEachEntry([&](unsigned int pageNumber, PageTableEntry& entry) {
+                if (!entry.present) {
+                    return;
+                }
+                // A frame claimed by an evicting thread is that thread's to reuse,
+                // even if it has already been handed to another process. A
+                // shared frame stays mapped for the other sharers.
+                Frame& frame = frames[entry.frameNumber];
+                if (frame.state == FrameState::Mapped && frame.pageNumber == static_cast<int>(pageNumber)
+                    && !unshareFrameLocked(entry.frameNumber, process) && frame.owner == process) {
+                    frame.state = FrameState::Free;
+                    frame.refCount = 0;
+                    replacementPolicy->onFree(entry.frameNumber);
+                    freedFrames.push_back(entry.frameNumber);
+                }
+                entry.present = false;
+                entry.frameNumber = -1;
+                entry.copyOnWrite = false;
+            });
+            for (HugeRegion& region : table->hugeRegions) {
+                if (region.frameNumber == -1) {
+                    continue;
+                }
+                Frame& frame = frames[region.frameNumber];
+                if (frame.state == FrameState::Mapped && frame.owner == process && frame.huge) {
+                    frame.state = FrameState::Free;
+                    frame.refCount = 0;
+                    replacementPolicy->onFree(region.frameNumber);
+                    freedHugeFrames.push_back(region.frameNumber);
+                }
+                region.frameNumber = -1;
+                numHugeMappings--;
+            }
+        }
+        if (!freedFrames.empty()) {
+            usedFrames -= static_cast<unsigned int>(freedFrames.size());
+            releaseFrames(freedFrames, coreId);
+        }
+        if (!freedHugeFrames.empty()) {
+            usedFrames -= static_cast<unsigned int>(freedHugeFrames.size()) * hugePageRatio;
+            releaseHugeFrames(freedHugeFrames);
+        }
+
+        std::lock_guard<std::mutex> swapLock(swapMutex);
+        table->entries.forEachEntry([&](unsigned int, PageTableEntry& entry) {
+            if (entry.swapSlot != -1) {
+                backingStore.freeSlot(entry.swapSlot);
+                entry.swapSlot = -1;
+            }
+        });
+        table->residentPages = 0;
+    }
+    if (segment) {
+        detachSegment(process, segment);
+    }
+
+    process->setPageTable(nullptr);
+    process->setInMemory(false);
+    numProcessesReleased++;
+}
+
+bool MemoryManager::forkMemory(Process* parent, Process* child) {
+    if (flatMemory) {
+        {
+            std::lock_guard<std::mutex> lock(memoryMutex);
+            child->shareMemoryWith(*parent);
+            // A swapped-out parent's words are in the backing store, not in the contents just shared
+            std::lock_guard<std::mutex> swapLock(swapMutex);
+            auto image = swappedImages.find(parent);
+            if (image != swappedImages.end()) {
+                for (const auto& chunk : image->second) {
+                    std::vector<char> bytes;
+                    if (backingStore.readSlot(chunk.second, bytes)) {
+                        child->restoreMemory(chunk.first, bytes);
+                    }
+                }
+            }
+        }
+        numForks++;
+        return allocateMemory(child, child->getMemorySize());
+    }
 
-MemoryManager::~MemoryManager() {}
+    std::shared_ptr<ProcessPageTable> parentTable = findPageTable(parent);
+    if (!parentTable) {
+        // The parent is not allocated; the child starts from its contents alone
+        child->shareMemoryWith(*parent);
+        numForks++;
+        return allocateMemory(child, child->getMemorySize());
+    }
 
-void MemoryManager::initialize(unsigned int maxMem, unsigned int memPerFrame) {
-    std::lock_guard<std::mutex> lock(memoryMutex);
+    std::shared_ptr<ProcessPageTable> table = std::make_shared<ProcessPageTable>();
+    std::shared_ptr<SharedSegment> segment;
+    unsigned int sharedPages = 0;
+    {
+        // The parent's pages cannot move in or out while its table is locked,
+        // so the contents and the mappings are copied consistently
+        std::unique_lock<std::mutex> parentLock(parentTable->mutex);
+        child->shareMemoryWith(*parent);
+        if (parentTable->released) {
+            // Allocating takes memoryMutex, which is never taken under a page table
+            parentLock.unlock();
+            numForks++;
+            return allocateMemory(child, child->getMemorySize());
+        }
+        // Pages of huge regions are not shared; the child gets base pages only
+        table->entries.initialize(parentTable->entries.size(), parentTable->entries.getLevels());
+        segment = parentTable->segment;
 
-    maxMemory = maxMem;
-    this->memPerFrame = memPerFrame;
-    totalFrames = maxMemory / memPerFrame;
-    flatMemory = (maxMemory == memPerFrame);
+        // The parent's cached translations turn read-only so its next write faults
+        for (auto& tlb : tlbs) {
+            std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+            tlb->writeProtectAddressSpace(parent->getId());
+        }
+
+        std::vector<unsigned int> swappedPages;
+        {
+            std::lock_guard<std::mutex> policyLock(policyMutex);
+            parentTable->entries.forEachEntry([&](unsigned int pageNumber, PageTableEntry& entry) {
+                if (!entry.present) {
+                    if (entry.swapSlot != -1) {
+                        swappedPages.push_back(pageNumber);
+                    }
+                    return;
+                }
+                // A frame already claimed by an eviction is not shared; the child faults the page in later
+                if (frames[entry.frameNumber].state != FrameState::Mapped) {
+                    return;
+                }
+                PageTableEntry& childEntry = table->entries.at(pageNumber);
+                childEntry.frameNumber = entry.frameNumber;
+                childEntry.present = true;
+                childEntry.copyOnWrite = true;
+                entry.copyOnWrite = true;
+                shareFrameLocked(entry.frameNumber, child);
+                sharedPages++;
+            });
+        }
+
+        // Swapped-out pages get a slot of their own in the child
+        if (!swappedPages.empty()) {
+            std::lock_guard<std::mutex> swapLock(swapMutex);
+            for (unsigned int pageNumber : swappedPages) {
+                std::vector<char> bytes;
+                if (!backingStore.readSlot(parentTable->entries.find(pageNumber)->swapSlot, bytes)) {
+                    continue;
+                }
+                int slot = backingStore.hasFreeSlot() ? backingStore.allocateSlot() : -1;
+                if (slot != -1 && backingStore.writeSlot(slot, bytes)) {
+                    table->entries.at(pageNumber).swapSlot = slot;
+                }
+                else {
+                    if (slot != -1) {
+                        backingStore.freeSlot(slot);
+                    }
+                    child->restoreMemory(pageNumber * memPerFrame, bytes);
+                }
+            }
+        }
+    }
+    table->residentPages = sharedPages;
+    child->setPageTable(table);
+    {
+        std::lock_guard<std::mutex> lock(pageTablesMutex);
+        pageTables[child] = table;
+    }
+    if (segment) {
+        // The child maps the parent's segment rather than a copy of it
+        std::lock_guard<std::mutex> lock(segmentsMutex);
+        mapSegmentLocked(child, segment);
+    }
+    child->getWorkingSet().setWindow(workingSetWindow);
+    if (workingSetWindow > 0) {
+        // The child starts out on its parent's frames, so it is admitted with it
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        activeProcesses.push_back(child);
+    }
+    child->setInMemory(true);
+    numForks++;
+    numPagesShared += sharedPages;
+    return true;
+}
 
+unsigned int MemoryManager::getUsedMemory() const {
     if (flatMemory) {
-        // Initialize single block of free memory
-        memoryBlocks.clear();
-        memoryBlocks.push_back({ 0, maxMemory, nullptr });
+        return static_cast<unsigned int>(contiguousUsed);
     }
     else {
-        // Initialize frames for paging
-        frames.resize(totalFrames);
-        for (auto& frame : frames) {
-            frame.allocated = false;
-            frame.owner = nullptr;
-            frame.pageNumber = -1;
-        }
+        return usedFrames * memPerFrame;
     }
 }
 
-/*
-void MemoryManager::compactMemory() {
-    if (!flatMemory) return;
+unsigned int MemoryManager::getTotalMemory() const {
+    return maxMemory;
+}
+
+unsigned int MemoryManager::getFreeMemory() const {
+    return getTotalMemory() - getUsedMemory();
+}
+
+double MemoryManager::getMemoryUtilization() const {
+    if (maxMemory == 0) {
+        return 0.0;
+    }
+    return (static_cast<double>(getUsedMemory()) / maxMemory) * 100.0;
+}
 
-    std::vector<MemoryBlock> newBlocks;
-    size_t currentOffset = 0;
+std::vector<ProcessMemoryUsage> MemoryManager::getProcessesInMemory() const {
+    std::vector<ProcessMemoryUsage> result;
 
-    // Move all allocated blocks to the front
-    for (const auto& block : memoryBlocks) {
-        if (block.process != nullptr) {
-            newBlocks.push_back({ currentOffset, block.size, block.process });
-            currentOffset += block.size;
+    if (flatMemory) {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        for (const auto& allocation : contiguousAllocator->getAllocations()) {
+            result.push_back({ allocation.first, static_cast<unsigned int>(allocation.second), 0 });
         }
     }
+    else {
+        std::vector<std::pair<Process*, std::shared_ptr<ProcessPageTable>>> tables;
+        {
+            std::lock_guard<std::mutex> lock(pageTablesMutex);
+            tables.assign(pageTables.begin(), pageTables.end());
+        }
+        // Resident counts are atomic; a table is only locked to read which segment it maps
+        for (const auto& pair : tables) {
+            unsigned int sharedKB = 0;
+            {
+                std::lock_guard<std::mutex> tableLock(pair.second->mutex);
+                if (pair.second->segment) {
+                    sharedKB = pair.second->segment->pages.residentPages * memPerFrame;
+                }
+            }
+            result.push_back({ pair.first, pair.second->residentPages * memPerFrame, sharedKB });
+        }
+    }
+
+    return result;
+}
+
+bool MemoryManager::isProcessInMemory(Process* process) const {
+    return process->isInMemory();
+}
+
+bool MemoryManager::isPaging() const {
+    return !flatMemory;
+}
+
+MemoryMode MemoryManager::getMemoryMode() const {
+    return memoryMode;
+}
 
-    // Add remaining space as a single free block
-    if (currentOffset < maxMemory) {
-        newBlocks.push_back({ currentOffset, maxMemory - currentOffset, nullptr });
+void MemoryManager::setSwapVictimPolicy(const std::string& name) {
+    std::lock_guard<std::mutex> lock(memoryMutex);
+    SwapVictimPolicy* policy = SwapVictimPolicy::create(name);
+    if (flatMemory && policy != nullptr) {
+        swapVictimPolicy.reset(policy);
     }
+    else {
+        delete policy;
+    }
+}
+
+void MemoryManager::configureSwapIo(unsigned int numThreads, unsigned int latencyUs, unsigned int bandwidthMBps) {
+    swapEngine.configure(numThreads, latencyUs, bandwidthMBps);
+}
+
+void MemoryManager::stopSwapIo() {
+    swapEngine.stop();
+}
+
+SwapIoStats MemoryManager::getSwapIoStats() const {
+    return swapEngine.getStats();
+}
+
+void MemoryManager::setSwapInListener(std::function<void(Process*)> listener) {
+    std::lock_guard<std::mutex> listenerLock(swapInListenerMutex);
+    swapInListener = listener;
+}
 
-    memoryBlocks = std::move(newBlocks);
+std::string MemoryManager::getSwapVictimPolicyName() const {
+    std::lock_guard<std::mutex> lock(memoryMutex);
+    return swapVictimPolicy ? swapVictimPolicy->getName() : "none";
 }
-*/
 
-bool MemoryManager::findFreeFrames(unsigned int numFramesNeeded, std::vector<int>& frameNumbers) {
-    frameNumbers.clear();
-    for (size_t i = 0; i < frames.size() && frameNumbers.size() < numFramesNeeded; ++i) {
-        if (!frames[i].allocated) {
-            frameNumbers.push_back(i);
+void MemoryManager::onProcessDispatched(Process* process, int coreId) {
+    if (!flatMemory) {
+        if (Tlb* tlb = coreTlb(coreId)) {
+            std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+            tlb->switchTo(process->getId());
         }
+        return;
     }
-    return frameNumbers.size() == numFramesNeeded;
+    std::lock_guard<std::mutex> lock(memoryMutex);
+    swapVictimPolicy->onDispatch(process);
+}
+
+void MemoryManager::onProcessDescheduled(Process* process) {
+    if (!flatMemory) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(memoryMutex);
+    swapVictimPolicy->onDeschedule(process);
 }
 
-void MemoryManager::removeOldestProcess() {
-    if (memoryQueue.empty()) return;
+void MemoryManager::configureTlb(unsigned int numEntries, unsigned int associativity, const std::string& replacement,
+    bool asidTagged) {
+    tlbs.clear();
+    if (flatMemory || numEntries == 0) {
+        return;
+    }
+    TlbReplacement tlbReplacement = TlbReplacement::Lru;
+    Tlb::parseReplacement(replacement, tlbReplacement);
+    unsigned int hugePageShift = 0;
+    while ((1u << hugePageShift) < hugePageRatio) {
+        ++hugePageShift;
+    }
+    for (unsigned int core = 0; core < numCores; ++core) {
+        tlbs.emplace_back(new Tlb());
+        tlbs.back()->initialize(numEntries, associativity, tlbReplacement, asidTagged, hugePageShift);
+    }
+}
 
-    Process* oldestProcess = memoryQueue.front();
-    memoryQueue.pop_front();
+bool MemoryManager::isTlbEnabled() const {
+    return !tlbs.empty();
+}
 
-    if (flatMemory) {
-        for (auto& block : memoryBlocks) {
-            if (block.process == oldestProcess) {
-                block.process = nullptr;
-                usedMemory -= block.size;
-                break; // Assuming one block per process
-            }
-        }
-        // Merge adjacent free blocks
-        mergeAdjacentFreeBlocks();
+std::string MemoryManager::getTlbConfiguration() const {
+    if (tlbs.empty()) {
+        return "off";
+    }
+    // Entries/ways and replacement, e.g. "16/4 lru"
+    const Tlb& tlb = *tlbs.front();
+    return std::to_string(tlb.getNumEntries()) + "/" + std::to_string(tlb.getAssociativity()) + " "
+        + Tlb::getReplacementName(tlb.getReplacement());
+}
 
-        // Mark process as swapped out
-        swappedOutProcesses.insert(oldestProcess);
-        oldestProcess->setInMemory(false);
+bool MemoryManager::isTlbAsidTagged() const {
+    return !tlbs.empty() && tlbs.front()->isAsidTagged();
+}
 
-        int processId = oldestProcess->getId();
-        std::string filename = std::to_string(processId) + ".txt";
-        std::ofstream outfile(filename);
-        if (outfile.is_open()) {
-            outfile << processId;
-            outfile.close();
-        }
-        else {
-            std::cerr << "Failed to create backing store file for process " << processId << std::endl;
-        }
+TlbStats MemoryManager::getTlbStats() const {
+    TlbStats total;
+    for (const TlbStats& stats : getTlbStatsPerCore()) {
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.flushes += stats.flushes;
+        total.shootdowns += stats.shootdowns;
     }
-    else {
-        auto it = pageTables.find(oldestProcess);
-        if (it != pageTables.end()) {
-            for (const auto& entry : it->second) {
-                if (entry.present) {
-                    frames[entry.frameNumber].allocated = false;
-                    frames[entry.frameNumber].owner = nullptr;
-                    frames[entry.frameNumber].pageNumber = -1;
-                    numPagedOut++;
-                }
-            }
-            pageTables.erase(it);
-        }
-        // Mark process as swapped out
-        swappedOutProcesses.insert(oldestProcess);
-        oldestProcess->setInMemory(false);
+    return total;
+}
+
+std::vector<TlbStats> MemoryManager::getTlbStatsPerCore() const {
+    std::vector<TlbStats> perCore;
+    for (const auto& tlb : tlbs) {
+        perCore.push_back(tlb->getStats());
     }
+    return perCore;
+}
+
+unsigned int MemoryManager::getNumProcessesReleased() const {
+    return numProcessesReleased;
+}
+
+unsigned int MemoryManager::getNumPrefetches() const {
+    return numPrefetches;
+}
+
+unsigned int MemoryManager::getNumThrottledAdmissions() const {
+    return numThrottledAdmissions;
+}
+
+void MemoryManager::setCompactionThreshold(unsigned int percent) {
+    compactionThreshold = percent;
 }
 
-void MemoryManager::mergeAdjacentFreeBlocks() {
-    for (size_t i = 0; i < memoryBlocks.size() - 1; ) {
-        if (memoryBlocks[i].process == nullptr && memoryBlocks[i + 1].process == nullptr) {
-            // Merge blocks
-            memoryBlocks[i].size += memoryBlocks[i + 1].size;
-            memoryBlocks.erase(memoryBlocks.begin() + i + 1);
+void MemoryManager::compactIncrementally() {
+    if (!flatMemory) {
+        if (hugePageRatio > 1) {
+            promoteHugePage();
         }
-        else {
-            ++i;
+        if (workingSetWindow > 0) {
+            controlLoad();
         }
+        return;
+    }
+    // Background work; skip this cycle rather than wait behind an allocation
+    std::unique_lock<std::mutex> lock(memoryMutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+        compactLocked();
     }
 }
 
-bool MemoryManager::allocateMemory(Process* process, unsigned int size) {
-    std::lock_guard<std::mutex> lock(memoryMutex);
+bool MemoryManager::compactLocked() {
+    if (!flatMemory || !contiguousAllocator || compactionThreshold >= 100) {
+        return false;
+    }
 
-    if (size > maxMemory) {
+    FragmentationStats stats = contiguousAllocator->getFragmentationStats();
+    if (stats.freeBlocks < 2 || stats.externalFragmentation < compactionThreshold) {
         return false;
     }
 
-    if (flatMemory) {
-        // Try to find a suitable free block or merge adjacent free blocks
-        while (true) {
-            for (size_t i = 0; i < memoryBlocks.size(); ++i) {
-                if (memoryBlocks[i].process == nullptr) {
-                    size_t combinedSize = memoryBlocks[i].size;
-                    size_t startIndex = i;
-                    size_t endIndex = i;
-
-                    // Check if current block is large enough
-                    if (combinedSize >= size) {
-                        // Allocate within this block
-                        if (combinedSize > size) {
-                            // Split the block
-                            MemoryBlock newBlock = {
-                                memoryBlocks[i].offset + size,
-                                memoryBlocks[i].size - size,
-                                nullptr
-                            };
-                            memoryBlocks.insert(memoryBlocks.begin() + i + 1, newBlock);
-                        }
-
-                        // Assign process to block
-                        memoryBlocks[i].size = size;
-                        memoryBlocks[i].process = process;
-                        usedMemory += size;
-                        memoryQueue.push_back(process);
-                        process->setInMemory(true);
-                        return true;
-                    }
+    size_t moved = contiguousAllocator->compact(COMPACTION_MOVES_PER_CYCLE);
+    if (moved == 0) {
+        return false;
+    }
+    numCompactionCycles++;
+    compactionBytesMoved += moved;
+    return true;
+}
 
-                    // Try to merge adjacent free blocks
-                    for (size_t j = i + 1; j < memoryBlocks.size(); ++j) {
-                        if (memoryBlocks[j].process == nullptr &&
-                            memoryBlocks[j].offset == memoryBlocks[endIndex].offset + memoryBlocks[endIndex].size) {
-                            combinedSize += memoryBlocks[j].size;
-                            endIndex = j;
-
-                            if (combinedSize >= size) {
-                                // Merge blocks from startIndex to endIndex
-                                memoryBlocks[startIndex].size = combinedSize;
-                                memoryBlocks[startIndex].process = process;
-                                usedMemory += size;
-                                memoryQueue.push_back(process);
-                                process->setInMemory(true);
-
-                                // Remove merged blocks except the first one
-                                memoryBlocks.erase(memoryBlocks.begin() + startIndex + 1, memoryBlocks.begin() + endIndex + 1);
-
-                                // If there's extra space, split the block
-                                if (combinedSize > size) {
-                                    MemoryBlock newBlock = {
-                                        memoryBlocks[startIndex].offset + size,
-                                        combinedSize - size,
-                                        nullptr
-                                    };
-                                    memoryBlocks.insert(memoryBlocks.begin() + startIndex + 1, newBlock);
-                                    memoryBlocks[startIndex].size = size;
-                                }
-
-                                return true;
-                            }
-                        }
-                        else {
-                            // Can't merge non-adjacent blocks
-                            break;
-                        }
-                    }
-                }
-            }
+uint64_t MemoryManager::activeWorkingSetLocked(unsigned int& averagePages) const {
+    uint64_t measuredPages = 0;
+    size_t measured = 0;
+    for (Process* process : activeProcesses) {
+        WorkingSet& workingSet = process->getWorkingSet();
+        if (!workingSet.isEmpty()) {
+            measuredPages += workingSet.getPages();
+            measured++;
+        }
+    }
+    averagePages = measured > 0 ? static_cast<unsigned int>(measuredPages / measured) : 0;
+    // Active processes that have not run yet are estimated like new arrivals
+    uint64_t pages = 0;
+    for (Process* process : activeProcesses) {
+        pages += estimateWorkingSetLocked(process, averagePages);
+    }
+    return pages;
+}
+
+unsigned int MemoryManager::estimateWorkingSetLocked(Process* process, unsigned int averagePages) const {
+    WorkingSet& workingSet = process->getWorkingSet();
+    if (!workingSet.isEmpty()) {
+        // A suspended process is expected back with the working set it left with
+        return workingSet.getPages();
+    }
+    // A window of references cannot touch more distinct pages than it holds
+    unsigned int numPages = (process->getMemorySize() + memPerFrame - 1) / memPerFrame;
+    unsigned int bound = std::min(numPages, workingSetWindow.load());
+    // An average of 0 means nothing has been measured yet, so only the bound is known
+    return averagePages > 0 ? std::min(bound, averagePages) : bound;
+}
+
+bool MemoryManager::admitWorkingSetLocked(Process* process) {
+    // With nothing active there is no one to make room for
+    if (activeProcesses.empty()) {
+        return true;
+    }
+    unsigned int averagePages;
+    uint64_t load = activeWorkingSetLocked(averagePages);
+    return load + estimateWorkingSetLocked(process, averagePages) <= totalFrames;
+}
+
+void MemoryManager::controlLoad() {
+    // Background work; skip this cycle rather than wait behind an admission
+    std::unique_lock<std::mutex> lock(memoryMutex, std::try_to_lock);
+    if (!lock.owns_lock() || activeProcesses.size() < 2) {
+        return;
+    }
+    unsigned int averagePages;
+    if (activeWorkingSetLocked(averagePages) <= totalFrames) {
+        return;
+    }
+    // The most recently admitted process has the least invested in its pages.
+    // If it is running, its core notices it left memory and requeues it.
+    Process* victim = activeProcesses.back();
+    activeProcesses.pop_back();
+    swappedOutProcesses.insert(victim);
+    victim->setInMemory(false);
+    numSuspensions++;
+    // Writing the pages out takes a while; admissions need not wait for it.
+    // A victim readmitted meanwhile faults its pages back in.
+    lock.unlock();
+    reclaimResidentPages(victim);
+}
+
+void MemoryManager::reclaimResidentPages(Process* process) {
+    std::shared_ptr<ProcessPageTable> table = findPageTable(process);
+    if (!table) {
+        return;
+    }
+    std::lock_guard<std::mutex> tableLock(table->mutex);
+    if (table->released) {
+        return;
+    }
+    for (auto& tlb : tlbs) {
+        std::lock_guard<std::mutex> tlbLock(tlb->getMutex());
+        tlb->invalidateAddressSpace(process->getId());
+    }
 
-            // No suitable contiguous free space found
-            // Attempt to remove oldest process
-            if (!memoryQueue.empty()) {
-                removeOldestProcess();
+    // Claimed as evicting, so the replacement policy cannot pick them while they are written out
+    std::vector<int> claimedPages;
+    std::vector<size_t> claimedRegions;
+    {
+        std::lock_guard<std::mutex> policyLock(policyMutex);
+        table->entries.forEachEntry([&](unsigned int pageNumber, PageTableEntry& entry) {
+            if (!entry.present) {
+                return;
             }
-            else {
-                // No processes to remove, allocation fails
-                return false;
+            Frame& frame = frames[entry.frameNumber];
+            if (frame.state == FrameState::Mapped && frame.owner == process && frame.refCount == 1
+                && frame.pageNumber == static_cast<int>(pageNumber) && !frame.huge) {
+                frame.state = FrameState::Evicting;
+                replacementPolicy->onFree(entry.frameNumber);
+                claimedPages.push_back(static_cast<int>(pageNumber));
+            }
+        });
+        for (size_t index = 0; index < table->hugeRegions.size(); ++index) {
+            int frameNumber = table->hugeRegions[index].frameNumber;
+            if (frameNumber == -1) {
+                continue;
+            }
+            Frame& frame = frames[frameNumber];
+            if (frame.state == FrameState::Mapped && frame.owner == process && frame.huge) {
+                frame.state = FrameState::Evicting;
+                replacementPolicy->onFree(frameNumber);
+                claimedRegions.push_back(index);
             }
         }
     }
-    else {
-        // Paging allocation remains unchanged
-        unsigned int numPages = (size + memPerFrame - 1) / memPerFrame;
-        std::vector<int> freeFrames;
 
-        while (!findFreeFrames(numPages, freeFrames)) {
-            if (!memoryQueue.empty()) {
-                removeOldestProcess();
-            }
-            else {
-                // No processes to remove, allocation fails
-                return false;
+    std::vector<int> freedFrames;
+    for (int pageNumber : claimedPages) {
+        PageTableEntry& entry = table->entries.at(pageNumber);
+        freedFrames.push_back(entry.frameNumber);
+        pageOut(process, entry, pageNumber);
+        entry.present = false;
+        entry.frameNumber = -1;
+        table->residentPages--;
+        HugeRegion* region = findHugeRegion(*table, pageNumber);
+        if (region != nullptr) {
+            region->residentBasePages--;
+            if (entry.swapSlot != -1) {
+                region->swappedBasePages++;
             }
         }
+    }
+    std::vector<int> freedHugeFrames;
+    for (size_t index : claimedRegions) {
+        int frameNumber = table->hugeRegions[index].frameNumber;
+        freedHugeFrames.push_back(frameNumber);
+        evictHugeLocked(process, *table, frameNumber, static_cast<int>(index * hugePageRatio));
+    }
+    {
+        std::lock_guard<std::mutex> policyLock(policyMutex);
+        for (int frameNumber : freedFrames) {
+            frames[frameNumber].state = FrameState::Free;
+            frames[frameNumber].refCount = 0;
+        }
+        for (int frameNumber : freedHugeFrames) {
+            frames[frameNumber].state = FrameState::Free;
+            frames[frameNumber].refCount = 0;
+        }
+    }
+    if (!freedFrames.empty()) {
+        usedFrames -= static_cast<unsigned int>(freedFrames.size());
+        releaseFrames(freedFrames, -1);
+    }
+    if (!freedHugeFrames.empty()) {
+        usedFrames -= static_cast<unsigned int>(freedHugeFrames.size()) * hugePageRatio;
+        releaseHugeFrames(freedHugeFrames);
+    }
+    numPagedOut += static_cast<unsigned int>(freedFrames.size() + freedHugeFrames.size());
+}
 
-        // Allocate frames
-        std::vector<PageTableEntry> pageTable(numPages);
-        for (size_t i = 0; i < numPages; ++i) {
-            int frameNum = freeFrames[i];
-            frames[frameNum].allocated = true;
-            frames[frameNum].owner = process;
-            frames[frameNum].pageNumber = i;
+unsigned int MemoryManager::getNumEvictions() const {
+    return numEvictions;
+}
 
-            pageTable[i].frameNumber = frameNum;
-            pageTable[i].present = true;
-            numPagedIn++;
-        }
+unsigned int MemoryManager::getNumCompactionCycles() const {
+    return numCompactionCycles;
+}
 
-        pageTables[process] = std::move(pageTable);
-        memoryQueue.push_back(process);
+uint64_t MemoryManager::getCompactionBytesMoved() const {
+    return compactionBytesMoved;
+}
 
-        process->setInMemory(true);
-        if (swappedOutProcesses.erase(process) > 0) {
-            // Process was in the backing store, so clear the content of the .txt file
-            int processId = process->getId();
-            std::string filename = std::to_string(processId) + ".txt";
-            std::ofstream outfile(filename, std::ios::trunc);
-            if (!outfile.is_open()) {
-                std::cerr << "Failed to open backing store file for process " << processId << " to empty it" << std::endl;
-            }
-            outfile.close();
-        }
+unsigned int MemoryManager::getIdleCpuTicks() const {
+    return idleCpuTicks;
+}
 
-        return true;
-    }
+unsigned int MemoryManager::getActiveCpuTicks() const {
+    return activeCpuTicks;
 }
 
-void MemoryManager::deallocateMemory(Process* process) {
-    std::lock_guard<std::mutex> lock(memoryMutex);
+unsigned int MemoryManager::getTotalCpuTicks() const {
+    return totalCpuTicks;
+}
 
-    if (flatMemory) {
-        bool found = false;
-
-        for (size_t i = 0; i < memoryBlocks.size(); ++i) {
-            if (memoryBlocks[i].process == process) {
-                usedMemory -= memoryBlocks[i].size;
-                memoryBlocks[i].process = nullptr;
-                found = true;
-                break;  // Assuming process occupies a single block
-            }
-        }
+unsigned int MemoryManager::getNumPagedIn() const {
+    return numPagedIn;
+}
 
-        if (found) {
-            // Merge adjacent free blocks
-            mergeAdjacentFreeBlocks();
-        }
+unsigned int MemoryManager::getNumPagedOut() const {
+    return numPagedOut;
+}
+
+unsigned int MemoryManager::getNumPageFaults() const {
+    return numPageFaults;
+}
+
+unsigned int MemoryManager::getNumMemoryAccesses() const {
+    return numMemoryAccesses;
+}
+
+void MemoryManager::configureHugePages(unsigned int ratio, unsigned int minProcessMemory) {
+    hugePageRatio = flatMemory ? 1 : std::max(1u, ratio);
+    hugePageMinProcessMemory = minProcessMemory;
+}
+
+bool MemoryManager::isHugePagesEnabled() const {
+    return hugePageRatio > 1;
+}
+
+HugePageStats MemoryManager::getHugePageStats() const {
+    HugePageStats stats;
+    stats.ratio = hugePageRatio;
+    stats.mappings = numHugeMappings;
+    unsigned int used = usedFrames;
+    stats.coverage = used > 0 ? std::min(100.0, 100.0 * stats.mappings * hugePageRatio / used) : 0.0;
+    stats.tlbEntriesSaved = static_cast<uint64_t>(stats.mappings) * (hugePageRatio - 1);
+    stats.promotions = numHugePromotions;
+    stats.demotions = numHugeDemotions;
+    stats.fallbacks = numHugeFallbacks;
+    uint64_t allocations = baseAllocations;
+    stats.baseAllocNsPerPage = allocations > 0 ? static_cast<double>(baseAllocNs) / allocations : 0.0;
+    allocations = hugeAllocations;
+    stats.hugeAllocNsPerPage = allocations > 0 ? static_cast<double>(hugeAllocNs) / (allocations * hugePageRatio) : 0.0;
+    return stats;
+}
+
+CopyOnWriteStats MemoryManager::getCopyOnWriteStats() const {
+    CopyOnWriteStats stats;
+    stats.forks = numForks;
+    stats.pagesShared = numPagesShared;
+    stats.copies = numCopyOnWriteCopies;
+    stats.reuses = numCopyOnWriteReuses;
+    std::lock_guard<std::mutex> policyLock(policyMutex);
+    stats.sharedFrames = static_cast<unsigned int>(frameSharers.size());
+    for (const auto& sharers : frameSharers) {
+        stats.framesSaved += static_cast<unsigned int>(sharers.second.size()) - 1;
     }
-    else {
-        // Paging deallocation remains unchanged
-        auto it = pageTables.find(process);
-        if (it != pageTables.end()) {
-            for (const auto& entry : it->second) {
-                if (entry.present) {
-                    frames[entry.frameNumber].allocated = false;
-                    frames[entry.frameNumber].owner = nullptr;
-                    frames[entry.frameNumber].pageNumber = -1;
-                    numPagedOut++;
-                }
-            }
-            pageTables.erase(it);
+    return stats;
+}
+
+SharedSegmentStats MemoryManager::getSharedSegmentStats() const {
+    SharedSegmentStats stats;
+    std::lock_guard<std::mutex> lock(segmentsMutex);
+    for (const auto& pair : segmentsById) {
+        SharedSegment& segment = *pair.second;
+        std::lock_guard<std::mutex> segmentLock(segment.pages.mutex);
+        uint64_t residentKB = static_cast<uint64_t>(segment.pages.residentPages) * memPerFrame;
+        stats.segments++;
+        stats.mappings += static_cast<unsigned int>(segment.users.size());
+        stats.residentKB += residentKB;
+        if (segment.users.size() > 1) {
+            stats.savedKB += residentKB * (segment.users.size() - 1);
         }
     }
+    return stats;
+}
 
-    memoryQueue.remove(process);
-    swappedOutProcesses.erase(process);
-    process->setInMemory(false);
+void MemoryManager::setWorkingSetWindow(unsigned int references) {
+    workingSetWindow = flatMemory ? 0 : references;
 }
 
-unsigned int MemoryManager::getUsedMemory() const {
+LoadControlStats MemoryManager::getLoadControlStats() const {
+    LoadControlStats stats;
+    stats.window = workingSetWindow;
+    stats.capacityPages = totalFrames;
+    stats.suspensions = numSuspensions;
+    stats.reactivations = numReactivations;
+    stats.refusals = numThrottledAdmissions;
+    if (stats.window == 0) {
+        return stats;
+    }
     std::lock_guard<std::mutex> lock(memoryMutex);
+    unsigned int averagePages;
+    stats.workingSetPages = activeWorkingSetLocked(averagePages);
+    stats.activeProcesses = static_cast<unsigned int>(activeProcesses.size());
+    stats.suspendedProcesses = static_cast<unsigned int>(swappedOutProcesses.size());
+    return stats;
+}
+
+void MemoryManager::setPageTableLevels(unsigned int levels) {
+    pageTableLevels = levels;
+}
 
+size_t MemoryManager::getTranslationMemoryUsage() const {
     if (flatMemory) {
-        return usedMemory;
+        return 0;
     }
-    else {
-        unsigned int usedFrames = 0;
-        for (const auto& frame : frames) {
-            if (frame.allocated) {
-                usedFrames++;
-            }
-        }
-        return usedFrames * memPerFrame;
+    size_t bytes = frames.getMemoryUsage();
+    std::lock_guard<std::mutex> lock(pageTablesMutex);
+    for (const auto& pair : pageTables) {
+        bytes += pair.second->entries.getMemoryUsage();
     }
+    return bytes;
 }
 
-unsigned int MemoryManager::getTotalMemory() const {
-    return maxMemory;
+std::string MemoryManager::getReplacementPolicyName() const {
+    return replacementPolicy ? replacementPolicy->getName() : "none";
 }
 
-unsigned int MemoryManager::getFreeMemory() const {
-    return getTotalMemory() - getUsedMemory();
+std::string MemoryManager::getAllocationPolicyName() const {
+    std::lock_guard<std::mutex> lock(memoryMutex);
+    return contiguousAllocator ? contiguousAllocator->getName() : "none";
 }
 
-double MemoryManager::getMemoryUtilization() const {
-    return (static_cast<double>(getUsedMemory()) / getTotalMemory()) * 100.0;
+FragmentationStats MemoryManager::getFragmentationStats() const {
+    std::lock_guard<std::mutex> lock(memoryMutex);
+    if (!contiguousAllocator) {
+        return FragmentationStats();
+    }
+    return contiguousAllocator->getFragmentationStats();
 }
 
-std::vector<std::pair<Process*, unsigned int>> MemoryManager::getProcessesInMemory() const {
-    std::lock_guard<std::mutex> lock(memoryMutex);
-    std::vector<std::pair<Process*, unsigned int>> result;
+MemoryMap MemoryManager::getMemoryMap() const {
+    MemoryMap map;
+    map.mode = memoryMode;
+    map.capacity = maxMemory;
+    map.refusedAdmissions = numRefusedAdmissions;
+    map.lastRefusedSize = lastRefusedSize;
 
     if (flatMemory) {
-        for (const auto& block : memoryBlocks) {
-            if (block.process != nullptr) {
-                result.emplace_back(block.process, block.size);
+        {
+            // Owners are resolved to ids under the lock; a process may be retired once it is released
+            std::lock_guard<std::mutex> lock(memoryMutex);
+            for (const BlockInfo& block : contiguousAllocator->getBlocks()) {
+                map.runs.push_back({ block.offset, block.size,
+                    block.owner != nullptr ? MemoryMapOwner::Process : MemoryMapOwner::Free,
+                    block.owner != nullptr ? block.owner->getId() : -1 });
             }
         }
     }
     else {
-        for (const auto& pair : pageTables) {
-            unsigned int numPages = 0;
-            for (const auto& entry : pair.second) {
-                if (entry.present) numPages++;
+        map.unit = memPerFrame;
+        unsigned int touchedFrames;
+        {
+            std::lock_guard<std::mutex> poolLock(poolMutex);
+            touchedFrames = nextUntouchedFrame;
+        }
+        {
+            // Mapped frames cannot be released while the policy lock is held, so their owners are alive
+            std::lock_guard<std::mutex> policyLock(policyMutex);
+            unsigned int frameNumber = 0;
+            while (frameNumber < touchedFrames) {
+                const Frame* frame = frames.find(static_cast<int>(frameNumber));
+                MemoryMapOwner owner = MemoryMapOwner::Free;
+                int ownerId = -1;
+                size_t length = 1;
+                if (frame != nullptr && frame->state == FrameState::Evicting) {
+                    owner = MemoryMapOwner::Evicting;
+                }
+                else if (frame != nullptr && frame->state == FrameState::Mapped) {
+                    if (frame->segmentId != -1) {
+                        owner = MemoryMapOwner::Segment;
+                        ownerId = frame->segmentId;
+                    }
+                    else {
+                        owner = frame->huge ? MemoryMapOwner::HugePage
+                            : frame->refCount > 1 ? MemoryMapOwner::CopyOnWrite : MemoryMapOwner::Process;
+                        ownerId = frame->owner != nullptr ? frame->owner->getId() : -1;
+                    }
+                    if (frame->huge) {
+                        // The frames behind the head have no state of their own
+                        length = hugePageRatio;
+                    }
+                }
+                MemoryMapRun* last = map.runs.empty() ? nullptr : &map.runs.back();
+                if (last != nullptr && last->owner == owner && last->ownerId == ownerId) {
+                    last->length += length;
+                }
+                else {
+                    map.runs.push_back({ frameNumber, length, owner, ownerId });
+                }
+                frameNumber += static_cast<unsigned int>(length);
+            }
+        }
+        if (touchedFrames < totalFrames) {
+            MemoryMapRun untouched = { touchedFrames, totalFrames - touchedFrames, MemoryMapOwner::Free, -1 };
+            if (!map.runs.empty() && map.runs.back().owner == MemoryMapOwner::Free) {
+                map.runs.back().length += untouched.length;
+            }
+            else {
+                map.runs.push_back(untouched);
             }
-            result.emplace_back(pair.first, numPages * memPerFrame);
         }
     }
 
-    return result;
+    for (const MemoryMapRun& run : map.runs) {
+        size_t size = run.length * map.unit;
+        if (run.owner == MemoryMapOwner::Free) {
+            map.freeKB += size;
+            map.holes++;
+            map.largestHole = std::max(map.largestHole, size);
+        }
+        else {
+            map.usedKB += size;
+        }
+    }
+    map.externalFragmentation = map.freeKB > 0
+        ? (1.0 - static_cast<double>(map.largestHole) / map.freeKB) * 100.0
+        : 0.0;
+    return map;
 }
 
-bool MemoryManager::isProcessInMemory(Process* process) const {
-    std::lock_guard<std::mutex> lock(memoryMutex);
-    return process->isInMemory();
+uint64_t MemoryManager::getNumSwapReads() const {
+    return backingStore.getNumReads();
 }
 
-bool MemoryManager::isPaging() const {
-    return !flatMemory;
+uint64_t MemoryManager::getNumSwapWrites() const {
+    return backingStore.getNumWrites();
 }
 
-unsigned int MemoryManager::getIdleCpuTicks() const {
-    return idleCpuTicks;
+uint64_t MemoryManager::getSwapKBRead() const {
+    return backingStore.getBytesRead();
 }
 
-unsigned int MemoryManager::getActiveCpuTicks() const {
-    return activeCpuTicks;
+uint64_t MemoryManager::getSwapKBWritten() const {
+    return backingStore.getBytesWritten();
 }
 
-unsigned int MemoryManager::getTotalCpuTicks() const {
-    return totalCpuTicks;
+unsigned int MemoryManager::getSwapSlotsUsed() const {
+    return backingStore.getUsedSlots();
 }
 
-unsigned int MemoryManager::getNumPagedIn() const {
-    return numPagedIn;
+unsigned int MemoryManager::getSwapSlotsTotal() const {
+    return backingStore.getNumSlots();
 }
 
-unsigned int MemoryManager::getNumPagedOut() const {
-    return numPagedOut;
+unsigned int MemoryManager::getNumSwapFullWrites() const {
+    return numSwapFullWrites;
 }
 
 void MemoryManager::incrementIdleCpuTicks() {
-    std::lock_guard<std::mutex> lock(memoryMutex);
     idleCpuTicks++;
     totalCpuTicks++;
 }
 
 void MemoryManager::incrementActiveCpuTicks() {
-    std::lock_guard<std::mutex> lock(memoryMutex);
     activeCpuTicks++;
     totalCpuTicks++;
 }
\ No newline at end of file
@@ -1,27 +1,144 @@
 #pragma once
 
 #include <map>
-#include <list>
 #include <mutex>
 #include <vector>
 #include <set>
+#include <memory>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <unordered_map>
 #include "Process.h"
+#include "PageReplacementPolicy.h"
+#include "BackingStore.h"
+#include "FlatAllocator.h"
+#include "BuddyAllocator.h"
+#include "SwapVictimPolicy.h"
+#include "SwapEngine.h"
+#include "Tlb.h"
+#include "FrameTable.h"
+#include "PageTable.h"
 
-struct MemoryBlock {
-    size_t offset;
-    size_t size;
+enum class MemoryMode { Flat, Paging, Buddy };
+
+// An aligned run of pages that can be backed by one huge frame. While it is
+// not, its pages are mapped one by one in the base page table.
+struct HugeRegion {
+    int frameNumber = -1;               // Huge frame while mapped huge, else -1
+    unsigned int residentBasePages = 0;
+    unsigned int swappedBasePages = 0;
+};
+
+struct HugePageStats {
+    unsigned int ratio = 1;             // Base frames per huge frame
+    unsigned int mappings = 0;          // Huge pages mapped now
+    double coverage = 0.0;              // Percent of used frames inside huge pages
+    uint64_t tlbEntriesSaved = 0;       // Base TLB entries the huge mappings' single entries stand for
+    unsigned int promotions = 0;
+    unsigned int demotions = 0;
+    unsigned int fallbacks = 0;         // Huge faults that found no free huge frame
+    // Taking a free frame from the allocator; evictions are not included
+    double baseAllocNsPerPage = 0.0;
+    double hugeAllocNsPerPage = 0.0;
+};
+
+struct CopyOnWriteStats {
+    unsigned int forks = 0;
+    uint64_t pagesShared = 0;           // Resident pages mapped into children at fork
+    unsigned int sharedFrames = 0;      // Frames mapped by more than one process now
+    unsigned int framesSaved = 0;       // Extra mappings of those frames, each a frame not allocated
+    unsigned int copies = 0;            // Writes that copied a shared frame
+    unsigned int reuses = 0;            // Writes that found the frame no longer shared
+};
+
+// Sizes are in KB, the unit of the memory settings
+struct SharedSegmentStats {
+    unsigned int segments = 0;
+    unsigned int mappings = 0;          // Processes attached, over all segments
+    uint64_t residentKB = 0;            // Segment pages in memory
+    uint64_t savedKB = 0;               // What a private copy for every further user would take
+};
+
+struct LoadControlStats {
+    unsigned int window = 0;            // References a working set spans; 0: load control off
+    unsigned int activeProcesses = 0;
+    unsigned int suspendedProcesses = 0;
+    uint64_t workingSetPages = 0;       // Estimated over the active processes
+    unsigned int capacityPages = 0;
+    unsigned int suspensions = 0;
+    unsigned int reactivations = 0;
+    unsigned int refusals = 0;          // Admissions refused because the working sets would not fit
+};
+
+// In KB, like SharedSegmentStats
+struct ProcessMemoryUsage {
     Process* process;
+    unsigned int privateKB;
+    unsigned int sharedKB;              // Resident pages of the segment it maps
+};
+
+enum class MemoryMapOwner { Free, Process, CopyOnWrite, HugePage, Segment, Evicting };
+
+// Consecutive blocks (flat, buddy) or frames (paging) held the same way
+struct MemoryMapRun {
+    size_t start;           // In units of the map
+    size_t length;
+    MemoryMapOwner owner;
+    int ownerId;            // Process or segment id; -1 when free or evicting
+};
+
+// Layout of physical memory at one moment. Flat and buddy runs are blocks
+// measured in KB, the unit of the memory settings, one run per block; paging
+// runs group frames.
+struct MemoryMap {
+    MemoryMode mode = MemoryMode::Flat;
+    size_t capacity = 0;                // KB
+    size_t unit = 1;                    // KB per unit of run start and length
+    std::vector<MemoryMapRun> runs;
+    size_t usedKB = 0;
+    size_t freeKB = 0;
+    size_t holes = 0;
+    size_t largestHole = 0;             // KB
+    double externalFragmentation = 0.0; // Percent of free memory outside the largest hole
+    unsigned int refusedAdmissions = 0; // Flat and buddy: admissions that found no room
+    size_t lastRefusedSize = 0;
+};
+
+struct SharedSegment;
+
+// Each process's page table has its own lock, so faults in different
+// processes proceed in parallel
+struct ProcessPageTable {
+    std::mutex mutex;
+    PageTable entries;
+    std::vector<HugeRegion> hugeRegions;    // Empty unless the process uses huge pages
+    std::atomic<unsigned int> residentPages{ 0 };
+    bool released = false;      // Set when the process is deallocated
+    // The segment's pages, from segmentFirstPage on, are in the segment's own table
+    std::shared_ptr<SharedSegment> segment;
+    int segmentFirstPage = -1;
 };
 
-struct Frame {
-    bool allocated;
-    Process* owner;
-    int pageNumber;
+// A named segment mapped at the top of several address spaces. Its pages have
+// one table of their own, so a page faulted in by any user is resident for all.
+struct SharedSegment {
+    int id = -1;
+    std::string name;
+    unsigned int size = 0;
+    ProcessPageTable pages;                 // pages.mutex also guards users
+    std::shared_ptr<SharedMemoryWords> words;
+    std::vector<std::pair<Process*, int>> users;    // Each user and the page the segment starts at
 };
 
-struct PageTableEntry {
-    int frameNumber;
-    bool present;
+// Free frames handed to one core in batches, so most faults never touch the
+// global pool
+struct FrameCache {
+    std::mutex mutex;
+    std::vector<int> frames;
 };
 
 class MemoryManager {
@@ -29,9 +146,54 @@ public:
     MemoryManager();
     ~MemoryManager();
 
-    void initialize(unsigned int maxMem, unsigned int memPerFrame);
+    void initialize(unsigned int maxMem, unsigned int memPerFrame, const std::string& replacementPolicy = "fifo",
+        const std::string& allocationPolicy = "first-fit", const std::string& memoryMode = "auto",
+        unsigned int numCores = 1);
     bool allocateMemory(Process* process, unsigned int size);
-    void deallocateMemory(Process* process);
+    // Brings a swapped-out process back in ahead of its dispatch, but only
+    // into memory that is already free
+    bool prefetchMemory(Process* process);
+    // coreId is the core the process ran on, whose frame cache takes its frames
+    void deallocateMemory(Process* process, int coreId = -1);
+    // Gives a forked child its parent's memory. In paging mode the child maps
+    // the parent's resident frames copy-on-write, and the first write to such
+    // a page by either side copies it. Flat and buddy modes allocate the child
+    // a block of its own.
+    bool forkMemory(Process* parent, Process* child);
+    CopyOnWriteStats getCopyOnWriteStats() const;
+    // Paging mode: maps the named segment over the top pages of the process,
+    // creating it on first use. It is freed when its last user is deallocated.
+    // Fails if the process is too small to keep its first page private.
+    bool attachSharedSegment(Process* process, const std::string& name, unsigned int size);
+    SharedSegmentStats getSharedSegmentStats() const;
+    // Paging mode load control: with a window of more than 0 references, a
+    // process runs only while its working set fits in memory beside those of
+    // the active processes. Refused processes stay suspended, with their pages
+    // written out, until allocateMemory admits them again. Call before any
+    // process is allocated.
+    void setWorkingSetWindow(unsigned int references);
+    LoadControlStats getLoadControlStats() const;
+
+    // Touches one address of the process; in paging mode a non-present page
+    // takes a fault and is loaded. Returns false if the access faulted.
+    // coreId selects the TLB consulted first and the frame cache a fault takes
+    // from; -1 goes straight to the page table.
+    bool accessMemory(Process* process, unsigned int address, bool write, int coreId = -1);
+
+    // Access plus the word transfer, done under one lock so the page cannot be
+    // evicted in between
+    uint16_t readMemory(Process* process, unsigned int address, int coreId = -1);
+    void writeMemory(Process* process, unsigned int address, uint16_t value, int coreId = -1);
+
+    // Paging mode: one TLB per core with this geometry; 0 entries disables
+    // them. Untagged TLBs are flushed whenever a core switches processes.
+    void configureTlb(unsigned int numEntries, unsigned int associativity, const std::string& replacement,
+        bool asidTagged);
+    bool isTlbEnabled() const;
+    std::string getTlbConfiguration() const;
+    bool isTlbAsidTagged() const;
+    TlbStats getTlbStats() const;
+    std::vector<TlbStats> getTlbStatsPerCore() const;
 
     unsigned int getTotalMemory() const;
     unsigned int getUsedMemory() const;
@@ -43,40 +205,231 @@ public:
     unsigned int getTotalCpuTicks() const;
     unsigned int getNumPagedIn() const;
     unsigned int getNumPagedOut() const;
+    unsigned int getNumPageFaults() const;
+    unsigned int getNumMemoryAccesses() const;
+    // Paging mode: page tables of new processes use this many levels (0 picks by size)
+    void setPageTableLevels(unsigned int levels);
+    // Bytes held by the frame table and all page tables
+    size_t getTranslationMemoryUsage() const;
+
+    // Paging mode: processes of at least minProcessMemory bytes fault in
+    // aligned runs of ratio pages as one huge frame when one is free. A ratio
+    // of 1 turns huge pages off. Call before configureTlb.
+    void configureHugePages(unsigned int ratio, unsigned int minProcessMemory);
+    bool isHugePagesEnabled() const;
+    HugePageStats getHugePageStats() const;
+    std::string getReplacementPolicyName() const;
+
+    // Flat and buddy modes only
+    std::string getAllocationPolicyName() const;
+    FragmentationStats getFragmentationStats() const;
+    // Locks are held only while the block or frame metadata is copied
+    MemoryMap getMemoryMap() const;
+
+    uint64_t getNumSwapReads() const;
+    uint64_t getNumSwapWrites() const;
+    // In KB, the unit of the memory settings: the swap file holds one byte
+    // for each one, so its byte counts are the KB moved
+    uint64_t getSwapKBRead() const;
+    uint64_t getSwapKBWritten() const;
+    unsigned int getSwapSlotsUsed() const;
+    unsigned int getSwapSlotsTotal() const;
+    // Pages and image chunks that found the swap area full; their contents
+    // stayed with the process instead of going to a slot
+    unsigned int getNumSwapFullWrites() const;
 
     void incrementIdleCpuTicks();
     void incrementActiveCpuTicks();
 
-    std::vector<std::pair<Process*, unsigned int>> getProcessesInMemory() const;
+    std::vector<ProcessMemoryUsage> getProcessesInMemory() const;
     bool isProcessInMemory(Process* process) const;
     bool isPaging() const;
+    MemoryMode getMemoryMode() const;
+
+    // Flat and buddy modes: which resident processes are swapped out to make
+    // room (fifo, lru or smallest-fit). Processes running on a core are
+    // never chosen, so schedulers report dispatches and deschedules.
+    void setSwapVictimPolicy(const std::string& name);
+    std::string getSwapVictimPolicyName() const;
+    // Flat and buddy modes: with I/O threads, swap-ins and swap-outs go to the
+    // swap engine instead of running on the caller. A process whose image is
+    // still coming in is refused admission, and the listener is called once it
+    // has arrived and the process is in memory.
+    void configureSwapIo(unsigned int numThreads, unsigned int latencyUs, unsigned int bandwidthMBps);
+    void stopSwapIo();
+    SwapIoStats getSwapIoStats() const;
+    void setSwapInListener(std::function<void(Process*)> listener);
+    void onProcessDispatched(Process* process, int coreId = -1);
+    void onProcessDescheduled(Process* process);
+
+    // Flat mode slides blocks together once external fragmentation reaches
+    // this percentage; 100 turns compaction off
+    void setCompactionThreshold(unsigned int percent);
+    // One bounded compaction step, run once per CPU cycle. In paging mode it
+    // promotes one fully resident region to a huge page instead, and suspends
+    // one process if the working sets no longer fit.
+    void compactIncrementally();
+
+    unsigned int getNumEvictions() const;
+    unsigned int getNumProcessesReleased() const;
+    unsigned int getNumPrefetches() const;
+    unsigned int getNumThrottledAdmissions() const;
+    unsigned int getNumCompactionCycles() const;
+    uint64_t getCompactionBytesMoved() const;
 
 private:
-    // void compactMemory();
-    void mergeAdjacentFreeBlocks();
-    bool findFreeFrames(unsigned int numFramesNeeded, std::vector<int>& frameNumbers);
-    void removeOldestProcess();
+    std::shared_ptr<ProcessPageTable> findPageTable(Process* process) const;
+    // Each core has a cache; callers not on a core (-1) share one more
+    FrameCache& frameCache(int coreId);
+    int acquireFrame(int coreId);
+    void releaseFrames(const std::vector<int>& frameNumbers, int coreId);
+    int obtainFrame(int coreId);
+    int evictVictim(int coreId);
+    // Locks the process's page table and makes the page resident; the lock
+    // is returned held so the caller can transfer a word before eviction
+    bool faultIn(Process* process, unsigned int address, bool write, int coreId,
+        std::shared_ptr<ProcessPageTable>& table, std::unique_lock<std::mutex>& tableLock);
+    // A fault inside the shared segment; swaps in the segment's table and returns it held
+    bool faultInSegment(Process* process, int pageNumber, int coreId, Tlb* tlb,
+        std::shared_ptr<ProcessPageTable>& table, std::unique_lock<std::mutex>& tableLock);
+    std::shared_ptr<SharedSegment> findSegment(int id) const;
+    // segmentsMutex held
+    bool mapSegmentLocked(Process* process, const std::shared_ptr<SharedSegment>& segment);
+    void detachSegment(Process* process, const std::shared_ptr<SharedSegment>& segment);
+    // A write to a copy-on-write page: maps a private copy unless the page is no longer shared
+    bool breakCopyOnWrite(Process* process, int pageNumber, ProcessPageTable& table, PageTableEntry& entry,
+        int coreId, Tlb* tlb, std::unique_lock<std::mutex>& tableLock);
+    // Policy lock held. Unsharing returns false unless the process was one of several sharers.
+    void shareFrameLocked(int frameNumber, Process* process);
+    bool unshareFrameLocked(int frameNumber, Process* process);
+    Tlb* coreTlb(int coreId) const;
+    // On a hit the TLB lock is returned held, which keeps the page resident
+    bool lookupTlb(Process* process, unsigned int address, bool write, int coreId,
+        std::unique_lock<std::mutex>& tlbLock);
+    void shootdownPage(Process* process, int pageNumber, bool huge = false);
+    // Null unless the page lies in a full huge-page-sized region of a process using huge pages
+    HugeRegion* findHugeRegion(ProcessPageTable& table, int pageNumber) const;
+    int takeHugeFrame();
+    void releaseHugeFrames(const std::vector<int>& headFrames);
+    bool faultInHuge(Process* process, int pageNumber, ProcessPageTable& table, HugeRegion& region, Tlb* tlb);
+    void evictHugeLocked(Process* owner, ProcessPageTable& table, int frameNumber, int pageNumber);
+    void promoteHugePage();
+    void pageOut(Process* process, PageTableEntry& entry, int pageNumber);
+    void pageIn(Process* process, PageTableEntry& entry, int pageNumber);
+    void swapOutImage(Process* process, unsigned int size);
+    void swapInImage(Process* process);
+    void completeSwapIn(Process* process, unsigned int size);
+    void releaseSwap(Process* process);
+    bool admitLocked(Process* process, unsigned int size, bool allowEviction);
+    bool isThrashingLocked();
+    void swapOutProcess(Process* victim);
+    bool compactLocked();
+    // memoryMutex held. Load is the working-set pages of the active processes.
+    uint64_t activeWorkingSetLocked(unsigned int& averagePages) const;
+    unsigned int estimateWorkingSetLocked(Process* process, unsigned int averagePages) const;
+    bool admitWorkingSetLocked(Process* process);
+    void controlLoad();
+    // Writes out and frees the process's private resident pages; pages shared
+    // copy-on-write or through a segment stay for their other users
+    void reclaimResidentPages(Process* process);
 
-    mutable std::mutex memoryMutex;
+    // Lock order: segmentsMutex or memoryMutex -> a process's page table -> its segment's table;
+    // memoryMutex or a page table -> a TLB -> policyMutex; memoryMutex -> the swap engine;
+    // a page table -> swapMutex or a frame cache; frame cache -> poolMutex.
+    // The policy lock is never held while taking a page table or TLB lock.
+    mutable std::mutex memoryMutex;     // Flat and buddy allocator state
+    mutable std::mutex pageTablesMutex; // The pageTables map itself
+    mutable std::mutex policyMutex;     // Replacement policy and frame states
+    mutable std::mutex poolMutex;       // Global free-frame bitmap
+    mutable std::mutex swapMutex;       // Backing store slots and file
     unsigned int maxMemory;
     unsigned int memPerFrame;
     unsigned int totalFrames;
-    bool flatMemory;
+    MemoryMode memoryMode;
+    bool flatMemory;    // Flat or buddy: each process holds one contiguous block
 
     // For flat memory allocation
-    std::vector<MemoryBlock> memoryBlocks;
-    unsigned int usedMemory;
+    std::unique_ptr<ContiguousAllocator> contiguousAllocator;
+    std::atomic<size_t> contiguousUsed;
 
     // For paging allocation
-    std::vector<Frame> frames;
-    std::map<Process*, std::vector<PageTableEntry>> pageTables;
+    FrameTable frames;
+    // Frames returned to the global pool; frames from nextUntouchedFrame on
+    // have never been handed out, so the pool only tracks what was used
+    std::vector<int> freeFramePool;
+    unsigned int nextUntouchedFrame;
+    std::atomic<unsigned int> pageTableLevels;
+
+    // Huge pages: whole free huge frames are kept apart from base frames and
+    // only split when no base frame is left. Base frames are not reassembled.
+    unsigned int hugePageRatio;
+    unsigned int hugePageMinProcessMemory;
+    std::vector<int> freeHugeFrames;                    // Guarded by poolMutex
+    std::mutex promotionMutex;
+    std::deque<std::pair<Process*, unsigned int>> promotionCandidates;
+    std::vector<std::unique_ptr<FrameCache>> frameCaches;
+    size_t frameBatchSize;
+    std::atomic<unsigned int> usedFrames;
+    std::unordered_map<Process*, std::shared_ptr<ProcessPageTable>> pageTables;
+    // Every process mapping a shared frame, for frames with refCount above 1.
+    // Guarded by policyMutex.
+    std::unordered_map<int, std::vector<Process*>> frameSharers;
+    mutable std::mutex segmentsMutex;
+    std::map<std::string, std::shared_ptr<SharedSegment>> segmentsByName;
+    std::unordered_map<int, std::shared_ptr<SharedSegment>> segmentsById;
+    int nextSegmentId;
+    std::unique_ptr<PageReplacementPolicy> replacementPolicy;
+    unsigned int numCores;
+    std::vector<std::unique_ptr<Tlb>> tlbs;
 
-    std::list<Process*> memoryQueue;
+    std::unique_ptr<SwapVictimPolicy> swapVictimPolicy;
+    // Flat and buddy: swapped out. Paging: suspended by load control.
     std::set<Process*> swappedOutProcesses;
+    // Paging load control, in the order they were admitted. Guarded by memoryMutex.
+    std::deque<Process*> activeProcesses;
+    std::atomic<unsigned int> workingSetWindow;
+    // Admitted, with their image still with the swap engine
+    std::set<Process*> pendingSwapIns;
+    std::mutex swapInListenerMutex;
+    std::function<void(Process*)> swapInListener;
+
+    // Swap file shared by both modes; flat mode keeps a whole process image
+    // as (offset, slot) chunks. Images are guarded by swapMutex.
+    BackingStore backingStore;
+    std::map<Process*, std::vector<std::pair<unsigned int, int>>> swappedImages;
+    SwapEngine swapEngine;
 
-    unsigned int numPagedIn;
-    unsigned int numPagedOut;
-    unsigned int idleCpuTicks;
-    unsigned int activeCpuTicks;
-    unsigned int totalCpuTicks;
+    // Statistics are atomic so queries never take a lock
+    std::atomic<unsigned int> numPagedIn;
+    std::atomic<unsigned int> numPagedOut;
+    std::atomic<unsigned int> numSwapFullWrites;
+    std::atomic<unsigned int> numPageFaults;
+    std::atomic<unsigned int> numMemoryAccesses;
+    std::atomic<unsigned int> numEvictions;
+    std::atomic<unsigned int> compactionThreshold;
+    std::atomic<unsigned int> numCompactionCycles;
+    std::atomic<uint64_t> compactionBytesMoved;
+    std::atomic<unsigned int> numProcessesReleased;
+    std::atomic<unsigned int> numPrefetches;
+    std::atomic<unsigned int> numThrottledAdmissions;
+    std::atomic<unsigned int> numRefusedAdmissions;
+    std::atomic<unsigned int> numSuspensions;
+    std::atomic<unsigned int> numReactivations;
+    std::atomic<size_t> lastRefusedSize;
+    std::atomic<unsigned int> numHugeMappings;
+    std::atomic<unsigned int> numHugePromotions;
+    std::atomic<unsigned int> numHugeDemotions;
+    std::atomic<unsigned int> numHugeFallbacks;
+    std::atomic<uint64_t> baseAllocNs;
+    std::atomic<uint64_t> baseAllocations;
+    std::atomic<uint64_t> hugeAllocNs;
+    std::atomic<uint64_t> hugeAllocations;
+    std::atomic<unsigned int> numForks;
+    std::atomic<uint64_t> numPagesShared;
+    std::atomic<unsigned int> numCopyOnWriteCopies;
+    std::atomic<unsigned int> numCopyOnWriteReuses;
+    std::deque<std::chrono::steady_clock::time_point> recentEvictions;
+    std::atomic<unsigned int> idleCpuTicks;
+    std::atomic<unsigned int> activeCpuTicks;
+    std::atomic<unsigned int> totalCpuTicks;
 };
\ No newline at end of file
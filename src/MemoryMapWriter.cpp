@@ -0,0 +1,107 @@
+#include "MemoryMapWriter.h"
+#include <iomanip>
+#include <sstream>
+
+MemoryMapWriter::MemoryMapWriter(MemoryManager& memoryManager, const std::atomic<unsigned int>& cycles)
+    : memoryManager(memoryManager), cycles(cycles), running(false), intervalMs(0), numSnapshots(0) {}
+
+MemoryMapWriter::~MemoryMapWriter() {
+    stop();
+}
+
+bool MemoryMapWriter::start(const std::string& path, unsigned int intervalMs) {
+    stop();
+    std::lock_guard<std::mutex> lock(mutex);
+    file.open(path, std::ios::app);
+    if (!file) {
+        return false;
+    }
+    this->path = path;
+    this->intervalMs = intervalMs;
+    running = true;
+    numSnapshots = 0;
+
+    MemoryMap map = memoryManager.getMemoryMap();
+    file << "# memmap mode=" << describeMode(map) << " capacity=" << map.capacity << " unit=" << map.unit
+        << " interval-ms=" << intervalMs << "\n";
+    writerThread = std::thread(&MemoryMapWriter::writerLoop, this);
+    return true;
+}
+
+void MemoryMapWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    cv.notify_all();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+    file.close();
+}
+
+bool MemoryMapWriter::isRunning() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running;
+}
+
+std::string MemoryMapWriter::getPath() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return path;
+}
+
+unsigned int MemoryMapWriter::getNumSnapshots() const {
+    return numSnapshots;
+}
+
+void MemoryMapWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        lock.unlock();
+        writeSnapshot();
+        lock.lock();
+        cv.wait_for(lock, std::chrono::milliseconds(intervalMs), [this]() { return !running; });
+    }
+}
+
+void MemoryMapWriter::writeSnapshot() {
+    MemoryMap map = memoryManager.getMemoryMap();
+    file << "cycle=" << cycles.load() << " used=" << map.usedKB << " free=" << map.freeKB
+        << " holes=" << map.holes << " largest=" << map.largestHole
+        << " ext=" << std::fixed << std::setprecision(1) << map.externalFragmentation
+        << " refused=" << map.refusedAdmissions << " map=" << encodeRuns(map) << "\n";
+    file.flush();
+    numSnapshots++;
+}
+
+std::string MemoryMapWriter::encodeRuns(const MemoryMap& map) {
+    std::ostringstream out;
+    for (size_t i = 0; i < map.runs.size(); ++i) {
+        const MemoryMapRun& run = map.runs[i];
+        if (i > 0) {
+            out << ',';
+        }
+        switch (run.owner) {
+        case MemoryMapOwner::Free: out << '-'; break;
+        case MemoryMapOwner::Process: out << 'p' << run.ownerId; break;
+        case MemoryMapOwner::CopyOnWrite: out << 'c' << run.ownerId; break;
+        case MemoryMapOwner::HugePage: out << 'h' << run.ownerId; break;
+        case MemoryMapOwner::Segment: out << 's' << run.ownerId; break;
+        case MemoryMapOwner::Evicting: out << 'e'; break;
+        }
+        out << ':' << run.length;
+    }
+    return out.str();
+}
+
+std::string MemoryMapWriter::describeMode(const MemoryMap& map) {
+    switch (map.mode) {
+    case MemoryMode::Flat: return "flat";
+    case MemoryMode::Buddy: return "buddy";
+    case MemoryMode::Paging: return "paging";
+    }
+    return "unknown";
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "MemoryManager.h"
+
+// Appends a memory map snapshot to a file at a fixed interval, one line per
+// snapshot, so fragmentation can be followed over a run
+class MemoryMapWriter {
+public:
+    MemoryMapWriter(MemoryManager& memoryManager, const std::atomic<unsigned int>& cycles);
+    ~MemoryMapWriter();
+
+    bool start(const std::string& path, unsigned int intervalMs);
+    void stop();
+    bool isRunning() const;
+    std::string getPath() const;
+    unsigned int getNumSnapshots() const;
+
+    // Runs as owner:length separated by commas, e.g. "p3:512,-:256,s0:4"
+    static std::string encodeRuns(const MemoryMap& map);
+    static std::string describeMode(const MemoryMap& map);
+
+private:
+    void writerLoop();
+    void writeSnapshot();
+
+    MemoryManager& memoryManager;
+    const std::atomic<unsigned int>& cycles;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::thread writerThread;
+    bool running;
+    unsigned int intervalMs;
+    std::string path;
+    std::ofstream file;                     // Writer thread only while running
+    std::atomic<unsigned int> numSnapshots;
+};
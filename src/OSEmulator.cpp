@@ -1,7 +1,61 @@
 #include "ConsoleManager.h"
+#include "BinaryTrace.h"
+#include "MemoryBenchmark.h"
 #include <iostream>
+#include <sstream>
+#include <string>
+
+static const char* DECODE_USAGE = "Usage: OSEmulator --decode-trace <file> [--process <name>] [--core <id>]";
+static const char* BENCH_USAGE = "Usage: OSEmulator --bench-memory [max-threads]";
+
+// The whole argument must be a number of at least minimum
+static bool parseNumber(const char* text, int minimum, int& value) {
+    std::istringstream iss(text);
+    char extra;
+    return (iss >> value) && !(iss >> extra) && value >= minimum;
+}
+
+static int decodeTrace(int argc, char* argv[]) {
+    std::string processFilter;
+    int coreFilter = -1;
+    for (int i = 3; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag != "--process" && flag != "--core") {
+            std::cerr << "Unknown option: " << flag << "\n" << DECODE_USAGE << "\n";
+            return 1;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << flag << "\n" << DECODE_USAGE << "\n";
+            return 1;
+        }
+        if (flag == "--process") {
+            processFilter = argv[i + 1];
+        }
+        else if (!parseNumber(argv[i + 1], 0, coreFilter)) {
+            std::cerr << "Invalid core id: " << argv[i + 1] << "\n" << DECODE_USAGE << "\n";
+            return 1;
+        }
+    }
+    return BinaryTraceDecoder::decode(argv[2], processFilter, coreFilter, std::cout) ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "--decode-trace") {
+        if (argc < 3) {
+            std::cerr << DECODE_USAGE << "\n";
+            return 1;
+        }
+        return decodeTrace(argc, argv);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--bench-memory") {
+        int maxThreads = 4;
+        if (argc > 3 || (argc == 3 && !parseNumber(argv[2], 1, maxThreads))) {
+            std::cerr << BENCH_USAGE << "\n";
+            return 1;
+        }
+        return runMemoryBenchmark(static_cast<unsigned int>(maxThreads), std::cout);
+    }
 
-int main() {
     std::cout << R"(  _____   _____    _____   _____    _______   _____   __    __ )" << "\n";
     std::cout << R"( / ____| / ____|  /  __ \  |  __ \  |  ____| / ____|  \ \  / / )" << "\n";
     std::cout << R"(| |      | (___   | |  | | | |__) | | |__    | (___    \ \/ /  )" << "\n";
@@ -0,0 +1,176 @@
+#include "PageReplacementPolicy.h"
+
+PageReplacementPolicy* PageReplacementPolicy::create(const std::string& name) {
+    if (name == "fifo") {
+        return new FifoReplacementPolicy();
+    }
+    else if (name == "lru") {
+        return new LruReplacementPolicy();
+    }
+    else if (name == "clock") {
+        return new ClockReplacementPolicy();
+    }
+    else if (name == "second-chance") {
+        return new SecondChanceReplacementPolicy();
+    }
+    return nullptr;
+}
+
+// FIFO
+
+void FifoReplacementPolicy::onLoad(int frameNumber) {
+    positions[frameNumber] = loadOrder.insert(loadOrder.end(), frameNumber);
+}
+
+void FifoReplacementPolicy::onAccess(int) {}
+
+void FifoReplacementPolicy::onFree(int frameNumber) {
+    auto it = positions.find(frameNumber);
+    if (it != positions.end()) {
+        loadOrder.erase(it->second);
+        positions.erase(it);
+    }
+}
+
+int FifoReplacementPolicy::selectVictim() {
+    if (loadOrder.empty()) return -1;
+    return loadOrder.front();
+}
+
+std::string FifoReplacementPolicy::getName() const {
+    return "fifo";
+}
+
+bool FifoReplacementPolicy::tracksAccesses() const {
+    return false;
+}
+
+// LRU
+
+void LruReplacementPolicy::onLoad(int frameNumber) {
+    positions[frameNumber] = recency.insert(recency.end(), frameNumber);
+}
+
+void LruReplacementPolicy::onAccess(int frameNumber) {
+    auto it = positions.find(frameNumber);
+    if (it != positions.end()) {
+        recency.splice(recency.end(), recency, it->second);
+    }
+}
+
+void LruReplacementPolicy::onFree(int frameNumber) {
+    auto it = positions.find(frameNumber);
+    if (it != positions.end()) {
+        recency.erase(it->second);
+        positions.erase(it);
+    }
+}
+
+int LruReplacementPolicy::selectVictim() {
+    if (recency.empty()) return -1;
+    return recency.front();
+}
+
+std::string LruReplacementPolicy::getName() const {
+    return "lru";
+}
+
+// Clock
+
+ClockReplacementPolicy::ClockReplacementPolicy() : hand(ring.end()) {}
+
+void ClockReplacementPolicy::advanceHand() {
+    if (++hand == ring.end()) {
+        hand = ring.begin();
+    }
+}
+
+void ClockReplacementPolicy::onLoad(int frameNumber) {
+    auto it = positions.find(frameNumber);
+    if (it != positions.end()) {
+        it->second->referenced = true;
+        return;
+    }
+    // New pages go just behind the hand, the last place it will reach
+    positions[frameNumber] = ring.insert(hand, Slot{ frameNumber, true });
+    if (hand == ring.end()) {
+        hand = ring.begin();
+    }
+}
+
+void ClockReplacementPolicy::onAccess(int frameNumber) {
+    auto it = positions.find(frameNumber);
+    if (it != positions.end()) {
+        it->second->referenced = true;
+    }
+}
+
+void ClockReplacementPolicy::onFree(int frameNumber) {
+    auto it = positions.find(frameNumber);
+    if (it == positions.end()) {
+        return;
+    }
+    if (hand == it->second) {
+        advanceHand();
+    }
+    ring.erase(it->second);
+    positions.erase(it);
+    if (ring.empty()) {
+        hand = ring.end();
+    }
+}
+
+int ClockReplacementPolicy::selectVictim() {
+    if (ring.empty()) return -1;
+    // At most two sweeps: the first may only clear reference bits
+    for (size_t step = 0; step < 2 * ring.size(); ++step) {
+        Slot& slot = *hand;
+        advanceHand();
+        if (slot.referenced) {
+            slot.referenced = false;
+            continue;
+        }
+        return slot.frameNumber;
+    }
+    return -1;
+}
+
+std::string ClockReplacementPolicy::getName() const {
+    return "clock";
+}
+
+// Second chance
+
+void SecondChanceReplacementPolicy::onLoad(int frameNumber) {
+    positions[frameNumber] = loadOrder.insert(loadOrder.end(), frameNumber);
+    referenced[frameNumber] = false;
+}
+
+void SecondChanceReplacementPolicy::onAccess(int frameNumber) {
+    referenced[frameNumber] = true;
+}
+
+void SecondChanceReplacementPolicy::onFree(int frameNumber) {
+    auto it = positions.find(frameNumber);
+    if (it != positions.end()) {
+        loadOrder.erase(it->second);
+        positions.erase(it);
+    }
+    referenced.erase(frameNumber);
+}
+
+int SecondChanceReplacementPolicy::selectVictim() {
+    while (!loadOrder.empty()) {
+        int frame = loadOrder.front();
+        if (!referenced[frame]) {
+            return frame;
+        }
+        referenced[frame] = false;
+        loadOrder.splice(loadOrder.end(), loadOrder, loadOrder.begin());
+    }
+    return -1;
+}
+
+std::string SecondChanceReplacementPolicy::getName() const {
+    return "second-chance";
+}
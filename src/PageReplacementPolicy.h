@@ -0,0 +1,91 @@
+#pragma once
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+// Chooses which resident page to evict when a page fault finds no free frame.
+// Policies see frames only through load/access/free notifications.
+class PageReplacementPolicy {
+public:
+    virtual ~PageReplacementPolicy() = default;
+
+    virtual void onLoad(int frameNumber) = 0;
+    virtual void onAccess(int frameNumber) = 0;
+    virtual void onFree(int frameNumber) = 0;
+    virtual int selectVictim() = 0;
+    virtual std::string getName() const = 0;
+    // False when onAccess does nothing, so hits can skip the policy entirely
+    virtual bool tracksAccesses() const { return true; }
+
+    static PageReplacementPolicy* create(const std::string& name);
+};
+
+// Evicts the page that was loaded first
+class FifoReplacementPolicy : public PageReplacementPolicy {
+public:
+    void onLoad(int frameNumber) override;
+    void onAccess(int frameNumber) override;
+    void onFree(int frameNumber) override;
+    int selectVictim() override;
+    std::string getName() const override;
+    bool tracksAccesses() const override;
+
+private:
+    std::list<int> loadOrder;
+    std::unordered_map<int, std::list<int>::iterator> positions;
+};
+
+// Evicts the page that was accessed least recently
+class LruReplacementPolicy : public PageReplacementPolicy {
+public:
+    void onLoad(int frameNumber) override;
+    void onAccess(int frameNumber) override;
+    void onFree(int frameNumber) override;
+    int selectVictim() override;
+    std::string getName() const override;
+
+private:
+    std::list<int> recency;
+    std::unordered_map<int, std::list<int>::iterator> positions;
+};
+
+// Sweeps a hand over the resident frames, clearing reference bits until it finds
+// an unreferenced page. Only resident frames are on the ring, so its size follows
+// memory in use rather than physical memory.
+class ClockReplacementPolicy : public PageReplacementPolicy {
+public:
+    ClockReplacementPolicy();
+    void onLoad(int frameNumber) override;
+    void onAccess(int frameNumber) override;
+    void onFree(int frameNumber) override;
+    int selectVictim() override;
+    std::string getName() const override;
+
+private:
+    struct Slot {
+        int frameNumber;
+        bool referenced;
+    };
+
+    void advanceHand();
+
+    std::list<Slot> ring;
+    std::unordered_map<int, std::list<Slot>::iterator> positions;
+    std::list<Slot>::iterator hand;
+};
+
+// FIFO order, but a referenced page is moved to the back once instead of being evicted
+class SecondChanceReplacementPolicy : public PageReplacementPolicy {
+public:
+    void onLoad(int frameNumber) override;
+    void onAccess(int frameNumber) override;
+    void onFree(int frameNumber) override;
+    int selectVictim() override;
+    std::string getName() const override;
+
+private:
+    std::list<int> loadOrder;
+    std::unordered_map<int, std::list<int>::iterator> positions;
+    std::unordered_map<int, bool> referenced;
+};
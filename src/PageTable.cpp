@@ -0,0 +1,89 @@
+#include "PageTable.h"
+
+static const PageTableEntry NOT_PRESENT = { -1, false, -1, false };
+
+PageTable::PageTable() : numPages(0), levels(1), memoryUsage(0) {}
+
+void PageTable::initialize(unsigned int numPages, unsigned int levels) {
+    this->numPages = numPages;
+    if (levels == 0) {
+        levels = numPages <= NODE_SIZE ? 1 : (numPages <= NODE_SIZE * NODE_SIZE ? 2 : 3);
+    }
+    this->levels = levels;
+
+    dense.clear();
+    leaves.clear();
+    directories.clear();
+    // The top level is sized up front and never grows, so entries never move
+    if (levels == 1) {
+        dense.assign(numPages, NOT_PRESENT);
+        memoryUsage = dense.size() * sizeof(PageTableEntry);
+    }
+    else if (levels == 2) {
+        leaves.resize((static_cast<size_t>(numPages) + NODE_SIZE - 1) >> NODE_BITS);
+        memoryUsage = leaves.size() * sizeof(std::unique_ptr<Leaf>);
+    }
+    else {
+        directories.resize((static_cast<size_t>(numPages) + NODE_SIZE * NODE_SIZE - 1) >> (2 * NODE_BITS));
+        memoryUsage = directories.size() * sizeof(std::unique_ptr<Directory>);
+    }
+}
+
+unsigned int PageTable::size() const {
+    return numPages;
+}
+
+unsigned int PageTable::getLevels() const {
+    return levels;
+}
+
+std::unique_ptr<PageTable::Leaf> PageTable::makeLeaf() {
+    std::unique_ptr<Leaf> leaf(new Leaf());
+    leaf->fill(NOT_PRESENT);
+    return leaf;
+}
+
+PageTableEntry* PageTable::find(unsigned int pageNumber) {
+    if (levels == 1) {
+        return &dense[pageNumber];
+    }
+    unsigned int offset = pageNumber & (NODE_SIZE - 1);
+    if (levels == 2) {
+        Leaf* leaf = leaves[pageNumber >> NODE_BITS].get();
+        return leaf ? &(*leaf)[offset] : nullptr;
+    }
+    Directory* directory = directories[pageNumber >> (2 * NODE_BITS)].get();
+    if (!directory) {
+        return nullptr;
+    }
+    Leaf* leaf = (*directory)[(pageNumber >> NODE_BITS) & (NODE_SIZE - 1)].get();
+    return leaf ? &(*leaf)[offset] : nullptr;
+}
+
+PageTableEntry& PageTable::at(unsigned int pageNumber) {
+    if (levels == 1) {
+        return dense[pageNumber];
+    }
+    unsigned int offset = pageNumber & (NODE_SIZE - 1);
+    std::unique_ptr<Leaf>* slot;
+    if (levels == 2) {
+        slot = &leaves[pageNumber >> NODE_BITS];
+    }
+    else {
+        std::unique_ptr<Directory>& directory = directories[pageNumber >> (2 * NODE_BITS)];
+        if (!directory) {
+            directory.reset(new Directory());
+            memoryUsage += sizeof(Directory);
+        }
+        slot = &(*directory)[(pageNumber >> NODE_BITS) & (NODE_SIZE - 1)];
+    }
+    if (!*slot) {
+        *slot = makeLeaf();
+        memoryUsage += sizeof(Leaf);
+    }
+    return (**slot)[offset];
+}
+
+size_t PageTable::getMemoryUsage() const {
+    return memoryUsage;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+struct PageTableEntry {
+    int frameNumber;
+    bool present;
+    int swapSlot;   // Backing store slot holding the page while it is out, or -1
+    bool copyOnWrite;   // Mapped read-only because the frame was shared by a fork
+};
+
+// One process's page table. Small tables are a dense array; larger ones are
+// a two- or three-level radix tree whose leaves are allocated on first use,
+// so a large address space costs memory only for the pages it touches.
+// Entry references stay valid until the table is destroyed.
+class PageTable {
+public:
+    static const unsigned int NODE_BITS = 9;
+    static const unsigned int NODE_SIZE = 1u << NODE_BITS;
+
+    PageTable();
+
+    // levels is 1 (dense), 2 or 3; 0 picks by size: dense up to one node of
+    // pages, two levels up to one node of leaves, three beyond that
+    void initialize(unsigned int numPages, unsigned int levels);
+
+    unsigned int size() const;
+    unsigned int getLevels() const;
+
+    // Null if the page's leaf was never materialized: not present, never swapped
+    PageTableEntry* find(unsigned int pageNumber);
+    // Materializes the page's leaf if needed
+    PageTableEntry& at(unsigned int pageNumber);
+
+    // Visits every materialized entry as fn(pageNumber, entry)
+    template <typename Fn>
+    void forEachEntry(Fn fn);
+
+    // Bytes held by materialized nodes, readable without the table lock
+    size_t getMemoryUsage() const;
+
+private:
+    using Leaf = std::array<PageTableEntry, NODE_SIZE>;
+    using Directory = std::array<std::unique_ptr<Leaf>, NODE_SIZE>;
+
+    static std::unique_ptr<Leaf> makeLeaf();
+
+    unsigned int numPages;
+    unsigned int levels;
+    std::vector<PageTableEntry> dense;                      // 1 level
+    std::vector<std::unique_ptr<Leaf>> leaves;              // 2 levels
+    std::vector<std::unique_ptr<Directory>> directories;    // 3 levels
+    std::atomic<size_t> memoryUsage;
+};
+
+template <typename Fn>
+void PageTable::forEachEntry(Fn fn) {
+    if (levels == 1) {
+        for (unsigned int page = 0; page < dense.size(); ++page) {
+            fn(page, dense[page]);
+        }
+        return;
+    }
+    auto visitLeaf = [&](Leaf& leaf, unsigned int firstPage) {
+        for (unsigned int offset = 0; offset < NODE_SIZE && firstPage + offset < numPages; ++offset) {
+            fn(firstPage + offset, leaf[offset]);
+        }
+    };
+    if (levels == 2) {
+        for (size_t index = 0; index < leaves.size(); ++index) {
+            if (leaves[index]) {
+                visitLeaf(*leaves[index], static_cast<unsigned int>(index << NODE_BITS));
+            }
+        }
+        return;
+    }
+    for (size_t top = 0; top < directories.size(); ++top) {
+        if (!directories[top]) {
+            continue;
+        }
+        for (size_t mid = 0; mid < NODE_SIZE; ++mid) {
+            if ((*directories[top])[mid]) {
+                visitLeaf(*(*directories[top])[mid], static_cast<unsigned int>(((top << NODE_BITS) + mid) << NODE_BITS));
+            }
+        }
+    }
+}
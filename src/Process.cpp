@@ -1,44 +1,62 @@
 #include "Process.h"
 #include "Command.h"
+#include "AsyncLogWriter.h"
 #include <fstream>
 #include <iostream>
 #include <ctime>
 #include <iomanip>
 #include <mutex>
+#include <algorithm>
 
 int Process::nextId = 1;
+static const unsigned int INSTRUCTION_SIZE = 4;
+// Forked relatives share written memory in chunks of this many bytes
+static const unsigned int WORD_CHUNK_SIZE = 64;
 bool Process::loggingEnabled = false;
 
 Process::Process(const std::string& name)
-    : name(name), currentLine(0), totalLines(0), completed(false),
-      memorySize(0), inMemory(false) {
+    : name(name), parentId(-1),
+      memorySize(0), inMemory(false), instructions(std::make_shared<InstructionList>()), instructionsShared(false), nextInstruction(0),
+      lastCoreId(-1), schedulingState(SchedulingState::New), intervalStartCycle(0), metrics(),
+      sharedBase(0), sharedSize(0), currentLine(0), totalLines(0), completed(false) {
     creationTime = std::chrono::system_clock::now();
+    arrivalTime = std::chrono::steady_clock::now();
+    intervalStartTime = arrivalTime;
     id = nextId++;
 
     if (loggingEnabled) {
         // Initialize process log file only if logging is enabled
-        std::ofstream logfile(name + ".txt", std::ios::out);
-        if (logfile.is_open()) {
-            logfile << "Process name: " << name << "\nLogs:\n";
-            logfile.close();
-        }
-        else {
-            std::cerr << "Unable to create log file for process " << name << std::endl;
-        }
+        AsyncLogWriter::getInstance().writeHeader(name, id);
     }
 }
 
-Process::~Process() {
-    while (!commandQueue.empty()) {
-        delete commandQueue.front();
-        commandQueue.pop();
+Process::Process(const std::string& name, Process& parent) : Process(name) {
+    parentId = parent.id;
+    memorySize = parent.memorySize;
+    {
+        std::lock_guard<std::mutex> lock(parent.queueMutex);
+        instructions = parent.instructions;
+        parent.instructionsShared = true;
+        instructionsShared = true;
+        nextInstruction = parent.nextInstruction;
     }
+    std::lock_guard<std::mutex> lock(parent.stateMutex);
+    // A fetched instruction the parent is still executing counts as done in the child
+    currentLine = static_cast<int>(nextInstruction);
+    totalLines = parent.totalLines;
+    symbolTable = parent.symbolTable;
 }
 
+Process::~Process() {}
+
 int Process::getId() const {
     return id;
 }
 
+int Process::getParentId() const {
+    return parentId;
+}
+
 const std::string& Process::getName() const {
     return name;
 }
@@ -62,52 +80,397 @@ bool Process::isInMemory() const {
 void Process::addCommand(Command* cmd) {
     {
         std::lock_guard<std::mutex> lock(queueMutex);
-        commandQueue.push(cmd);
+        if (instructionsShared) {
+            // Forked relatives keep the list they were created with
+            instructions = std::make_shared<InstructionList>(*instructions);
+            instructionsShared = false;
+        }
+        instructions->emplace_back(cmd);
     }
 
-    // Store command description for display
-    {
-        std::lock_guard<std::mutex> lock(stateMutex);
-        totalLines++;
-        codeLines.push_back(cmd->getDescription());
-    }
+    std::lock_guard<std::mutex> lock(stateMutex);
+    totalLines++;
 }
 
 Command* Process::getNextCommand() {
     std::lock_guard<std::mutex> lock(queueMutex);
-    if (commandQueue.empty()) {
+    if (nextInstruction >= instructions->size()) {
         return nullptr;
     }
-    Command* cmd = commandQueue.front();
-    commandQueue.pop();
-    return cmd;
+    return (*instructions)[nextInstruction++].get();
+}
+
+void Process::returnCommand() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (nextInstruction > 0) {
+        nextInstruction--;
+    }
 }
 
 void Process::log(const std::string& message, int coreId) {
     if (!loggingEnabled) return;
 
-    std::lock_guard<std::mutex> lock(logMutex);
-    // Open the process's log file and append the message
-    std::ofstream logfile(name + ".txt", std::ios::app);
+    // File I/O happens on the log writer thread; this only queues the record
+    AsyncLogWriter::getInstance().write(name, id, message, coreId);
+}
 
-    if (logfile.is_open()) {
-        // Get current time
-        std::time_t now = std::time(nullptr);
-        std::tm now_tm;
+std::time_t Process::getCreationTime() const {
+    return std::chrono::system_clock::to_time_t(creationTime);
+}
 
-        localtime_s(&now_tm, &now);
+std::time_t Process::getFinishTime() const {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return std::chrono::system_clock::to_time_t(finishTime);
+}
+
+int Process::getLastCoreId() const {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return lastCoreId;
+}
+
+unsigned int Process::getNumCoresUsed() const {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return static_cast<unsigned int>(coresUsed.count());
+}
 
-        logfile << "(" << std::put_time(&now_tm, "%m/%d/%Y %I:%M:%S%p") << ") ";
-        logfile << "Core:" << coreId << " \"" << message << "\"\n";
-        logfile.close();
+static double elapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// Adds the time since the last transition to whichever state the process was in
+void Process::closeIntervalLocked(unsigned int cycle) {
+    auto now = std::chrono::steady_clock::now();
+    // Cycle stamps are read before taking the lock, so they can trail the previous one slightly
+    if (cycle < intervalStartCycle) {
+        cycle = intervalStartCycle;
+    }
+    unsigned int cycles = cycle - intervalStartCycle;
+    double ms = elapsedMs(intervalStartTime, now);
+
+    switch (schedulingState) {
+    case SchedulingState::Ready:
+        metrics.waitingCycles += cycles;
+        metrics.waitingMs += ms;
+        break;
+    case SchedulingState::Running:
+        metrics.runCycles += cycles;
+        metrics.runMs += ms;
+        break;
+    case SchedulingState::MemoryBlocked:
+        metrics.memoryBlockedCycles += cycles;
+        metrics.memoryBlockedMs += ms;
+        break;
+    default:
+        break;
+    }
+
+    intervalStartCycle = cycle;
+    intervalStartTime = now;
+}
+
+void Process::onReady(unsigned int cycle) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (schedulingState == SchedulingState::New) {
+        metrics.arrivalCycle = cycle;
+        intervalStartCycle = cycle;
+        intervalStartTime = arrivalTime;
+    }
+    else if (schedulingState == SchedulingState::MemoryBlocked || schedulingState == SchedulingState::Ready) {
+        // Still waiting for memory (or already queued); keep accounting to the same state
+        return;
     }
     else {
-        std::cerr << "Unable to open log file for process " << name << std::endl;
+        closeIntervalLocked(cycle);
+        metrics.completed = false;
     }
+    schedulingState = SchedulingState::Ready;
 }
 
-std::time_t Process::getCreationTime() const {
-    return std::chrono::system_clock::to_time_t(creationTime);
+void Process::onDispatch(unsigned int cycle, int coreId) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    closeIntervalLocked(cycle);
+
+    if (!metrics.dispatched) {
+        metrics.dispatched = true;
+        metrics.firstDispatchCycle = cycle;
+        metrics.responseMs = elapsedMs(arrivalTime, intervalStartTime);
+    }
+    if (lastCoreId != -1 && lastCoreId != coreId) {
+        metrics.migrations++;
+    }
+
+    lastCoreId = coreId;
+    coresUsed.set(coreId);
+    schedulingState = SchedulingState::Running;
+}
+
+void Process::onPreempt(unsigned int cycle) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    closeIntervalLocked(cycle);
+    metrics.preemptions++;
+    schedulingState = SchedulingState::Ready;
+}
+
+void Process::onMemoryBlocked(unsigned int cycle) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    closeIntervalLocked(cycle);
+    schedulingState = SchedulingState::MemoryBlocked;
+}
+
+void Process::onComplete(unsigned int cycle) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    closeIntervalLocked(cycle);
+    metrics.completed = true;
+    metrics.completionCycle = cycle;
+    metrics.turnaroundMs = elapsedMs(arrivalTime, intervalStartTime);
+    schedulingState = SchedulingState::Done;
+}
+
+ProcessMetrics Process::getMetrics(unsigned int cycle) const {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    ProcessMetrics snapshot = metrics;
+
+    unsigned int cycles = cycle >= intervalStartCycle ? cycle - intervalStartCycle : 0;
+    double ms = elapsedMs(intervalStartTime, std::chrono::steady_clock::now());
+    switch (schedulingState) {
+    case SchedulingState::Ready:
+        snapshot.waitingCycles += cycles;
+        snapshot.waitingMs += ms;
+        break;
+    case SchedulingState::Running:
+        snapshot.runCycles += cycles;
+        snapshot.runMs += ms;
+        break;
+    case SchedulingState::MemoryBlocked:
+        snapshot.memoryBlockedCycles += cycles;
+        snapshot.memoryBlockedMs += ms;
+        break;
+    default:
+        break;
+    }
+    return snapshot;
+}
+
+unsigned int Process::getInstructionAddress() const {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (memorySize == 0) {
+        return 0;
+    }
+    return (static_cast<unsigned int>(currentLine) * INSTRUCTION_SIZE) % memorySize;
+}
+
+bool Process::declareVariable(const std::string& variable, unsigned int& address) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto it = symbolTable.find(variable);
+    if (it != symbolTable.end()) {
+        address = it->second;
+        return true;
+    }
+
+    unsigned int nextAddress = static_cast<unsigned int>(symbolTable.size() * sizeof(uint16_t));
+    if (nextAddress + sizeof(uint16_t) > SYMBOL_TABLE_SIZE || nextAddress + sizeof(uint16_t) > memorySize) {
+        return false;
+    }
+    symbolTable[variable] = nextAddress;
+    address = nextAddress;
+    return true;
+}
+
+Process::ChunkWords& Process::ownWordChunkLocked(unsigned int address) {
+    WordChunk& chunk = memoryWords[address / WORD_CHUNK_SIZE];
+    if (!chunk.words) {
+        chunk.words = std::make_shared<ChunkWords>();
+    }
+    else if (chunk.shared) {
+        chunk.words = std::make_shared<ChunkWords>(*chunk.words);
+        chunk.shared = false;
+    }
+    return *chunk.words;
+}
+
+bool Process::isSharedAddress(unsigned int address) const {
+    return sharedWords && address >= sharedBase && address - sharedBase < sharedSize;
+}
+
+uint16_t Process::readWord(unsigned int address) const {
+    if (isSharedAddress(address)) {
+        std::lock_guard<std::mutex> lock(sharedWords->mutex);
+        auto it = sharedWords->words.find(address - sharedBase);
+        return it != sharedWords->words.end() ? it->second : 0;
+    }
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto chunk = memoryWords.find(address / WORD_CHUNK_SIZE);
+    if (chunk == memoryWords.end()) {
+        return 0;
+    }
+    auto it = chunk->second.words->find(address);
+    return it != chunk->second.words->end() ? it->second : 0;
+}
+
+void Process::writeWord(unsigned int address, uint16_t value) {
+    if (isSharedAddress(address)) {
+        std::lock_guard<std::mutex> lock(sharedWords->mutex);
+        sharedWords->words[address - sharedBase] = value;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(stateMutex);
+    ownWordChunkLocked(address)[address] = value;
+}
+
+static bool extractWords(std::unordered_map<unsigned int, uint16_t>& words, unsigned int begin, unsigned int length,
+    std::vector<char>& bytes) {
+    bytes.assign(length, 0);
+    bool written = false;
+    for (unsigned int offset = 0; offset + 1 < length; offset += sizeof(uint16_t)) {
+        auto it = words.find(begin + offset);
+        if (it != words.end()) {
+            bytes[offset] = static_cast<char>(it->second & 0xFF);
+            bytes[offset + 1] = static_cast<char>(it->second >> 8);
+            words.erase(it);
+            written = true;
+        }
+    }
+    return written;
+}
+
+static void restoreWords(std::unordered_map<unsigned int, uint16_t>& words, unsigned int begin,
+    const std::vector<char>& bytes) {
+    for (size_t offset = 0; offset + 1 < bytes.size(); offset += sizeof(uint16_t)) {
+        uint16_t value = static_cast<uint16_t>(static_cast<unsigned char>(bytes[offset]) |
+            (static_cast<unsigned char>(bytes[offset + 1]) << 8));
+        if (value != 0) {
+            words[begin + static_cast<unsigned int>(offset)] = value;
+        }
+    }
+}
+
+template <typename Place>
+bool Process::extractChunkLocked(MemoryWords::iterator chunk, Place place) {
+    // The words place() has no byte image for stay behind. They go into a
+    // new map, so a chunk still shared with a relative is never changed.
+    ChunkWords kept;
+    bool moved = false;
+    for (const auto& word : *chunk->second.words) {
+        char* bytes = place(word.first);
+        if (bytes != nullptr) {
+            bytes[0] = static_cast<char>(word.second & 0xFF);
+            bytes[1] = static_cast<char>(word.second >> 8);
+            moved = true;
+        }
+        else {
+            kept.insert(word);
+        }
+    }
+    if (moved) {
+        chunk->second.words = std::make_shared<ChunkWords>(std::move(kept));
+        chunk->second.shared = false;
+    }
+    return moved;
+}
+
+bool Process::extractMemory(unsigned int begin, unsigned int length, std::vector<char>& bytes) {
+    if (isSharedAddress(begin)) {
+        std::lock_guard<std::mutex> lock(sharedWords->mutex);
+        return extractWords(sharedWords->words, begin - sharedBase, length, bytes);
+    }
+    bytes.assign(length, 0);
+    if (length == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto place = [&](unsigned int address) -> char* {
+        unsigned int offset = address - begin;
+        return address >= begin && offset + 1 < length && offset % sizeof(uint16_t) == 0 ? &bytes[offset] : nullptr;
+    };
+    bool written = false;
+    // Only the chunks overlapping the range are visited
+    for (unsigned int chunkNumber = begin / WORD_CHUNK_SIZE; chunkNumber <= (begin + length - 1) / WORD_CHUNK_SIZE; ++chunkNumber) {
+        auto chunk = memoryWords.find(chunkNumber);
+        if (chunk != memoryWords.end() && extractChunkLocked(chunk, place)) {
+            written = true;
+            if (chunk->second.words->empty()) {
+                memoryWords.erase(chunk);
+            }
+        }
+    }
+    return written;
+}
+
+void Process::extractMemoryChunks(unsigned int size, unsigned int chunkSize,
+    std::map<unsigned int, std::vector<char>>& chunks) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    // Only the words written so far are visited, not every address of the image
+    auto place = [&](unsigned int address) -> char* {
+        unsigned int offset = address % chunkSize;
+        unsigned int chunkStart = address - offset;
+        unsigned int length = chunkStart < size ? std::min(chunkSize, size - chunkStart) : 0;
+        if (address >= size || offset % sizeof(uint16_t) != 0 || offset + 1 >= length) {
+            return nullptr;
+        }
+        std::vector<char>& bytes = chunks[chunkStart];
+        if (bytes.empty()) {
+            bytes.assign(length, 0);
+        }
+        return &bytes[offset];
+    };
+    for (auto chunk = memoryWords.begin(); chunk != memoryWords.end();) {
+        if (extractChunkLocked(chunk, place) && chunk->second.words->empty()) {
+            chunk = memoryWords.erase(chunk);
+        }
+        else {
+            ++chunk;
+        }
+    }
+}
+
+void Process::restoreMemory(unsigned int begin, const std::vector<char>& bytes) {
+    if (isSharedAddress(begin)) {
+        std::lock_guard<std::mutex> lock(sharedWords->mutex);
+        restoreWords(sharedWords->words, begin - sharedBase, bytes);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(stateMutex);
+    for (size_t offset = 0; offset + 1 < bytes.size(); offset += sizeof(uint16_t)) {
+        uint16_t value = static_cast<uint16_t>(static_cast<unsigned char>(bytes[offset]) |
+            (static_cast<unsigned char>(bytes[offset + 1]) << 8));
+        if (value != 0) {
+            unsigned int address = begin + static_cast<unsigned int>(offset);
+            ownWordChunkLocked(address)[address] = value;
+        }
+    }
+}
+
+void Process::shareMemoryWith(Process& other) {
+    MemoryWords words;
+    {
+        // Every chunk is shared from here on; contents are copied only by a write
+        std::lock_guard<std::mutex> lock(other.stateMutex);
+        for (auto& chunk : other.memoryWords) {
+            chunk.second.shared = true;
+        }
+        words = other.memoryWords;
+    }
+    std::lock_guard<std::mutex> lock(stateMutex);
+    memoryWords.swap(words);
+}
+
+void Process::mapSharedMemory(std::shared_ptr<SharedMemoryWords> words, unsigned int base, unsigned int size) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    sharedWords = words;
+    sharedBase = base;
+    sharedSize = size;
+}
+
+WorkingSet& Process::getWorkingSet() {
+    return workingSet;
+}
+
+void Process::setPageTable(std::shared_ptr<ProcessPageTable> table) {
+    pageTable = std::move(table);
+}
+
+const std::shared_ptr<ProcessPageTable>& Process::getPageTable() const {
+    return pageTable;
 }
 
 int Process::getCurrentLine() const {
@@ -121,9 +484,10 @@ int Process::getTotalLines() const {
 }
 
 std::string Process::getCurrentCodeLine() const {
-    std::lock_guard<std::mutex> lock(stateMutex);
-    if (currentLine > 0 && currentLine <= totalLines) {
-        return codeLines[currentLine - 1];
+    int line = getCurrentLine();
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (line > 0 && static_cast<size_t>(line) <= instructions->size()) {
+        return (*instructions)[line - 1]->getDescription();
     }
     else {
         return "No code line is currently being executed.";
@@ -143,6 +507,9 @@ void Process::incrementCurrentLine() {
 void Process::setCompleted(bool value) {
     std::lock_guard<std::mutex> lock(stateMutex);
     completed = value;
+    if (value) {
+        finishTime = std::chrono::system_clock::now();
+    }
 }
 
 void Process::resetCompleted() {
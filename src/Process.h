@@ -1,20 +1,65 @@
 #pragma once
 
 #include <string>
-#include <queue>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <chrono>
 #include <vector>
+#include <bitset>
+#include <cstdint>
+#include <unordered_map>
+#include <map>
+#include "WorkingSet.h"
 
 class Command;
+struct ProcessPageTable;
+
+// Contents of a shared memory segment, keyed by offset within the segment
+struct SharedMemoryWords {
+    std::mutex mutex;
+    std::unordered_map<unsigned int, uint16_t> words;
+};
+
+// Scheduling timeline of a process, in simulated CPU cycles and wall time
+struct ProcessMetrics {
+    bool dispatched;
+    bool completed;
+
+    unsigned int arrivalCycle;
+    unsigned int firstDispatchCycle;
+    unsigned int completionCycle;
+
+    unsigned int waitingCycles;
+    unsigned int runCycles;
+    unsigned int memoryBlockedCycles;
+
+    double responseMs;
+    double turnaroundMs;
+    double waitingMs;
+    double runMs;
+    double memoryBlockedMs;
+
+    unsigned int preemptions;
+    unsigned int migrations;
+
+    unsigned int getResponseCycles() const { return firstDispatchCycle - arrivalCycle; }
+    unsigned int getTurnaroundCycles() const { return completionCycle - arrivalCycle; }
+};
 
 class Process {
 public:
     Process(const std::string& name);
+    // A forked child: shares the parent's instructions until one of them adds
+    // more, and resumes after the parent's last fetched instruction. Memory
+    // contents come from MemoryManager::forkMemory.
+    Process(const std::string& name, Process& parent);
     ~Process();
 
     const std::string& getName() const;
     int getId() const;
+    // Id of the process this one was forked from, or -1
+    int getParentId() const;
 
     void setMemorySize(unsigned int size);
     unsigned int getMemorySize() const;
@@ -22,12 +67,62 @@ public:
     void setInMemory(bool inMemory);
     bool isInMemory() const;
 
+    // Takes ownership of the command
     void addCommand(Command* cmd);
+    // The command stays owned by the process
     Command* getNextCommand();
+    // Puts the last fetched command back so it is fetched again
+    void returnCommand();
 
     void log(const std::string& message, int coreId);
 
     std::time_t getCreationTime() const;
+    std::time_t getFinishTime() const;
+
+    int getLastCoreId() const;
+    unsigned int getNumCoresUsed() const;
+
+    // Scheduling state transitions, stamped with the current CPU cycle
+    void onReady(unsigned int cycle);
+    void onDispatch(unsigned int cycle, int coreId);
+    void onPreempt(unsigned int cycle);
+    void onMemoryBlocked(unsigned int cycle);
+    void onComplete(unsigned int cycle);
+
+    // Includes the interval the process is currently in, up to the given cycle
+    ProcessMetrics getMetrics(unsigned int cycle) const;
+
+    // Address of the next instruction in the process's memory
+    unsigned int getInstructionAddress() const;
+
+    // Variables live in a symbol table at the start of page 0, one 16-bit
+    // word each. Returns false when the table is full.
+    bool declareVariable(const std::string& variable, unsigned int& address);
+
+    // Contents of the process's simulated memory; unwritten words read as 0
+    uint16_t readWord(unsigned int address) const;
+    void writeWord(unsigned int address, uint16_t value);
+
+    // Moves the words in [begin, begin + length) out to a byte image (little
+    // endian), or back in. extractMemory returns false if nothing was written there.
+    bool extractMemory(unsigned int begin, unsigned int length, std::vector<char>& bytes);
+    // Moves every word below size out in one pass, as images of the chunks of
+    // chunkSize bytes that hold any, keyed by chunk offset
+    void extractMemoryChunks(unsigned int size, unsigned int chunkSize, std::map<unsigned int, std::vector<char>>& chunks);
+    void restoreMemory(unsigned int begin, const std::vector<char>& bytes);
+    // Starts from another process's memory contents, shared until either side changes them
+    void shareMemoryWith(Process& other);
+    // Maps a shared segment's contents at [base, base + size). Words there are
+    // seen by every process mapping the segment. Call before the process runs.
+    void mapSharedMemory(std::shared_ptr<SharedMemoryWords> words, unsigned int base, unsigned int size);
+    // Pages referenced recently, for paging load control
+    WorkingSet& getWorkingSet();
+    // Paging mode: the process's page table, set by MemoryManager while the
+    // process is not running so the core running it needs no lookup
+    void setPageTable(std::shared_ptr<ProcessPageTable> table);
+    const std::shared_ptr<ProcessPageTable>& getPageTable() const;
+
+    static const unsigned int SYMBOL_TABLE_SIZE = 64;
 
     int getCurrentLine() const;
     int getTotalLines() const;
@@ -42,27 +137,70 @@ public:
     static bool isLoggingEnabled();
 
 private:
+    enum class SchedulingState { New, Ready, Running, MemoryBlocked, Done };
+
+    void closeIntervalLocked(unsigned int cycle);
+
+    using InstructionList = std::vector<std::shared_ptr<Command>>;
+    // Written words by address, grouped in chunks keyed by chunk number. A
+    // fork shares every chunk, and a change copies only the chunk it is in.
+    using ChunkWords = std::unordered_map<unsigned int, uint16_t>;
+    struct WordChunk {
+        std::shared_ptr<ChunkWords> words;
+        bool shared = false;    // Same rule as instructionsShared
+    };
+    using MemoryWords = std::unordered_map<unsigned int, WordChunk>;
+
+    // Gives this process its own copy of the chunk holding the address before a change
+    ChunkWords& ownWordChunkLocked(unsigned int address);
+    // Moves the chunk's words out to where place(address) points, two bytes
+    // each; words it returns null for are kept
+    template <typename Place>
+    bool extractChunkLocked(MemoryWords::iterator chunk, Place place);
+    bool isSharedAddress(unsigned int address) const;
+
     std::string name;
     int id;
+    int parentId;
 
     static int nextId;
 
     unsigned int memorySize;
-    bool inMemory;
+    std::atomic<bool> inMemory;     // Set by swap I/O threads as well as the schedulers
 
-    std::queue<Command*> commandQueue;
+    // Shared with forked relatives; a shared list is never changed, only
+    // copied by whichever side adds to it
+    std::shared_ptr<InstructionList> instructions;
+    bool instructionsShared;
+    size_t nextInstruction;
     mutable std::mutex queueMutex;
 
     std::chrono::system_clock::time_point creationTime;
+    std::chrono::system_clock::time_point finishTime;
+
+    int lastCoreId;
+    std::bitset<128> coresUsed;
+
+    SchedulingState schedulingState;
+    unsigned int intervalStartCycle;
+    std::chrono::steady_clock::time_point intervalStartTime;
+    std::chrono::steady_clock::time_point arrivalTime;
+    ProcessMetrics metrics;
+
+    std::unordered_map<std::string, unsigned int> symbolTable;
+    MemoryWords memoryWords;
+    std::shared_ptr<SharedMemoryWords> sharedWords;
+    unsigned int sharedBase;
+    unsigned int sharedSize;
+    WorkingSet workingSet;
+    std::shared_ptr<ProcessPageTable> pageTable;
 
-    std::vector<std::string> codeLines;
     int currentLine;
     int totalLines;
     bool completed;
 
     mutable std::mutex stateMutex;
 
-    std::mutex logMutex;
 
     static bool loggingEnabled;
 };
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "ProcessArchive.h"
+
+void ProcessArchive::archive(const Process* process) {
+    std::lock_guard<std::mutex> lock(archiveMutex);
+
+    unsigned int nameId;
+    auto it = nameIds.find(process->getName());
+    if (it != nameIds.end()) {
+        nameId = it->second;
+    }
+    else {
+        nameId = static_cast<unsigned int>(names.size());
+        names.push_back(process->getName());
+        nameIds[process->getName()] = nameId;
+    }
+
+    nameIdColumn.push_back(nameId);
+    pidColumn.push_back(process->getId());
+    creationTimeColumn.push_back(process->getCreationTime());
+    finishTimeColumn.push_back(process->getFinishTime());
+    instructionCountColumn.push_back(static_cast<unsigned int>(process->getTotalLines()));
+    lastCoreColumn.push_back(process->getLastCoreId());
+    coresUsedColumn.push_back(process->getNumCoresUsed());
+    // A finished process has no open interval, so the cycle argument does not matter
+    metricsColumn.push_back(process->getMetrics(0));
+}
+
+bool ProcessArchive::contains(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(archiveMutex);
+    return nameIds.find(name) != nameIds.end();
+}
+
+size_t ProcessArchive::size() const {
+    std::lock_guard<std::mutex> lock(archiveMutex);
+    return pidColumn.size();
+}
+
+std::vector<ArchivedProcess> ProcessArchive::getRecords() const {
+    std::lock_guard<std::mutex> lock(archiveMutex);
+    std::vector<ArchivedProcess> records;
+    records.reserve(pidColumn.size());
+    for (size_t i = 0; i < pidColumn.size(); ++i) {
+        records.push_back({
+            nameIdColumn[i],
+            pidColumn[i],
+            creationTimeColumn[i],
+            finishTimeColumn[i],
+            instructionCountColumn[i],
+            lastCoreColumn[i],
+            coresUsedColumn[i],
+            metricsColumn[i]
+        });
+    }
+    return records;
+}
+
+std::string ProcessArchive::getName(unsigned int nameId) const {
+    std::lock_guard<std::mutex> lock(archiveMutex);
+    return names[nameId];
+}
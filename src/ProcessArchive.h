@@ -0,0 +1,48 @@
+#pragma once
+
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Process.h"
+
+// Fixed-size summary of a retired process
+struct ArchivedProcess {
+    unsigned int nameId;
+    int pid;
+    std::time_t creationTime;
+    std::time_t finishTime;
+    unsigned int instructionCount;
+    int lastCoreId;
+    unsigned int numCoresUsed;
+    ProcessMetrics metrics;
+};
+
+// Column-oriented store of retired processes. Keeps only the summary
+// fields so the full Process objects can be freed once they finish.
+class ProcessArchive {
+public:
+    void archive(const Process* process);
+
+    bool contains(const std::string& name) const;
+    size_t size() const;
+
+    std::vector<ArchivedProcess> getRecords() const;
+    std::string getName(unsigned int nameId) const;
+
+private:
+    mutable std::mutex archiveMutex;
+
+    std::vector<std::string> names;
+    std::unordered_map<std::string, unsigned int> nameIds;
+
+    std::vector<unsigned int> nameIdColumn;
+    std::vector<int> pidColumn;
+    std::vector<std::time_t> creationTimeColumn;
+    std::vector<std::time_t> finishTimeColumn;
+    std::vector<unsigned int> instructionCountColumn;
+    std::vector<int> lastCoreColumn;
+    std::vector<unsigned int> coresUsedColumn;
+    std::vector<ProcessMetrics> metricsColumn;
+};
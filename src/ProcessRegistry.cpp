@@ -0,0 +1,106 @@
+#include "ProcessRegistry.h"
+
+bool ProcessRegistry::enqueue(Process* process) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (readyIndex.find(process) != readyIndex.end()) {
+        return false;
+    }
+    eraseLocked(process);
+    readyIndex[process] = ready.insert(ready.end(), process);
+    epoch++;
+    return true;
+}
+
+void ProcessRegistry::dequeue(Process* process) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = readyIndex.find(process);
+    if (it != readyIndex.end()) {
+        ready.erase(it->second);
+        readyIndex.erase(it);
+        dispatchingIndex[process] = dispatching.insert(dispatching.end(), process);
+        epoch++;
+    }
+}
+
+void ProcessRegistry::dispatch(Process* process, int coreId) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    eraseLocked(process);
+    running[process] = coreId;
+    epoch++;
+}
+
+void ProcessRegistry::finish(Process* process) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    eraseLocked(process);
+    finishedIndex[process] = finished.insert(finished.end(), process);
+    epoch++;
+}
+
+std::vector<Process*> ProcessRegistry::takeFinished() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<Process*> result(finished.begin(), finished.end());
+    finished.clear();
+    finishedIndex.clear();
+    epoch++;
+    return result;
+}
+
+std::vector<Process*> ProcessRegistry::getQueued() const {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<Process*> result(dispatching.begin(), dispatching.end());
+    result.insert(result.end(), ready.begin(), ready.end());
+    return result;
+}
+
+std::map<Process*, int> ProcessRegistry::getRunning() const {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return std::map<Process*, int>(running.begin(), running.end());
+}
+
+std::vector<Process*> ProcessRegistry::getFinished() const {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return std::vector<Process*>(finished.begin(), finished.end());
+}
+
+std::shared_ptr<const SchedulerSnapshot> ProcessRegistry::getSnapshot() const {
+    std::shared_ptr<const SchedulerSnapshot> current = std::atomic_load(&snapshot);
+    if (current && current->epoch == epoch.load()) {
+        return current;
+    }
+
+    std::shared_ptr<SchedulerSnapshot> fresh = std::make_shared<SchedulerSnapshot>();
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        fresh->epoch = epoch.load();
+        fresh->running.insert(running.begin(), running.end());
+        fresh->queued.assign(dispatching.begin(), dispatching.end());
+        fresh->queued.insert(fresh->queued.end(), ready.begin(), ready.end());
+        fresh->finished.assign(finished.begin(), finished.end());
+    }
+    // Racing readers may publish out of order; an older copy only costs the next reader a rebuild
+    std::atomic_store(&snapshot, std::shared_ptr<const SchedulerSnapshot>(fresh));
+    return fresh;
+}
+
+// A process is in at most one state; drop it from whichever one it is in
+void ProcessRegistry::eraseLocked(Process* process) {
+    auto readyIt = readyIndex.find(process);
+    if (readyIt != readyIndex.end()) {
+        ready.erase(readyIt->second);
+        readyIndex.erase(readyIt);
+    }
+
+    auto dispatchingIt = dispatchingIndex.find(process);
+    if (dispatchingIt != dispatchingIndex.end()) {
+        dispatching.erase(dispatchingIt->second);
+        dispatchingIndex.erase(dispatchingIt);
+    }
+
+    running.erase(process);
+
+    auto finishedIt = finishedIndex.find(process);
+    if (finishedIt != finishedIndex.end()) {
+        finished.erase(finishedIt->second);
+        finishedIndex.erase(finishedIt);
+    }
+}
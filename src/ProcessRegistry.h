@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Process;
+
+// The registry's lists as of one epoch; every process it tracks is in
+// exactly one of them
+struct SchedulerSnapshot {
+    uint64_t epoch = 0;
+    std::map<Process*, int> running;    // Core each process runs on
+    std::vector<Process*> queued;       // Those taken by the dispatcher first
+    std::vector<Process*> finished;
+};
+
+// Tracks which processes a scheduler has queued, running and finished.
+// Every transition is O(1), so re-queueing does not depend on how many
+// processes have ever been scheduled.
+class ProcessRegistry {
+public:
+    bool enqueue(Process* process);
+    // Taken off the ready queue by the dispatcher; it counts as queued until
+    // it is dispatched or enqueued again
+    void dequeue(Process* process);
+    void dispatch(Process* process, int coreId);
+    void finish(Process* process);
+    std::vector<Process*> takeFinished();
+
+    std::vector<Process*> getQueued() const;
+    std::map<Process*, int> getRunning() const;
+    std::vector<Process*> getFinished() const;
+    // Readers share one snapshot until the next transition, so monitoring
+    // only takes the lock, for one copy, after the lists have changed
+    std::shared_ptr<const SchedulerSnapshot> getSnapshot() const;
+
+private:
+    void eraseLocked(Process* process);
+
+    mutable std::mutex registryMutex;
+    // Bumped under the lock by every transition; read without it
+    std::atomic<uint64_t> epoch{ 0 };
+    // Accessed with std::atomic_load and std::atomic_store
+    mutable std::shared_ptr<const SchedulerSnapshot> snapshot;
+
+    std::list<Process*> ready;
+    std::unordered_map<Process*, std::list<Process*>::iterator> readyIndex;
+
+    std::list<Process*> dispatching;
+    std::unordered_map<Process*, std::list<Process*>::iterator> dispatchingIndex;
+
+    std::unordered_map<Process*, int> running;
+
+    std::list<Process*> finished;
+    std::unordered_map<Process*, std::list<Process*>::iterator> finishedIndex;
+};
@@ -0,0 +1,25 @@
+#include "ReadCommand.h"
+#include "Process.h"
+#include "MemoryManager.h"
+#include <sstream>
+
+ReadCommand::ReadCommand(MemoryManager& memoryManager, const std::string& variable, unsigned int address)
+    : memoryManager(memoryManager), variable(variable), address(address) {}
+
+void ReadCommand::execute(Process* process, int coreId) {
+    if (address + 1 >= process->getMemorySize()) {
+        return;
+    }
+    uint16_t value = memoryManager.readMemory(process, address, coreId);
+
+    unsigned int variableAddress;
+    if (process->declareVariable(variable, variableAddress)) {
+        memoryManager.writeMemory(process, variableAddress, value, coreId);
+    }
+}
+
+std::string ReadCommand::getDescription() const {
+    std::ostringstream oss;
+    oss << "read " << variable << " 0x" << std::hex << std::uppercase << address;
+    return oss.str();
+}
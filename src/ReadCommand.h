@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Command.h"
+
+class MemoryManager;
+
+// READ var address: loads a 16-bit word from memory into a variable
+class ReadCommand : public Command {
+public:
+    ReadCommand(MemoryManager& memoryManager, const std::string& variable, unsigned int address);
+    void execute(Process* process, int coreId) override;
+    std::string getDescription() const override;
+
+private:
+    MemoryManager& memoryManager;
+    std::string variable;
+    unsigned int address;
+};
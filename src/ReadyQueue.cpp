@@ -0,0 +1,121 @@
+#include "ReadyQueue.h"
+#include "Process.h"
+#include <algorithm>
+
+// Resident processes dispatched in a row before a waiting swapped-out one is taken
+static const unsigned int MAX_RESIDENT_STREAK = 4;
+// Memory-blocked processes retry on their own after this long without a wake-up
+static const std::chrono::milliseconds BLOCKED_RETRY_INTERVAL(20);
+
+ReadyQueue::ReadyQueue() : residentStreak(0), stopped(false) {}
+
+void ReadyQueue::push(Process* process) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (process->isInMemory()) {
+        resident.push_back(process);
+    }
+    else {
+        swappedOut.push_back(process);
+    }
+    cv.notify_one();
+}
+
+void ReadyQueue::pushMemoryBlocked(Process* process) {
+    std::lock_guard<std::mutex> lock(mtx);
+    // Its swap-in may have completed since the admission was refused
+    if (process->isInMemory()) {
+        resident.push_back(process);
+    }
+    else {
+        memoryBlocked.push_back(process);
+    }
+    cv.notify_one();
+}
+
+void ReadyQueue::wakeMemoryBlocked() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (memoryBlocked.empty()) {
+        return;
+    }
+    swappedOut.insert(swappedOut.end(), memoryBlocked.begin(), memoryBlocked.end());
+    memoryBlocked.clear();
+    cv.notify_one();
+}
+
+void ReadyQueue::wakeMemoryBlocked(Process* process) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = std::find(memoryBlocked.begin(), memoryBlocked.end(), process);
+    if (it == memoryBlocked.end()) {
+        return;
+    }
+    memoryBlocked.erase(it);
+    resident.push_back(process);
+    cv.notify_one();
+}
+
+bool ReadyQueue::waitAndPop(Process*& process) {
+    std::unique_lock<std::mutex> lock(mtx);
+    for (;;) {
+        if (!resident.empty() || !swappedOut.empty()) {
+            popLocked(process);
+            return true;
+        }
+        if (stopped) {
+            return false;
+        }
+        if (memoryBlocked.empty()) {
+            cv.wait(lock);
+        }
+        else if (cv.wait_for(lock, BLOCKED_RETRY_INTERVAL) == std::cv_status::timeout) {
+            // Nothing released memory in time; let the blocked processes retry
+            swappedOut.insert(swappedOut.end(), memoryBlocked.begin(), memoryBlocked.end());
+            memoryBlocked.clear();
+        }
+    }
+}
+
+void ReadyQueue::popLocked(Process*& process) {
+    bool takeResident = !resident.empty()
+        && (swappedOut.empty() || residentStreak < MAX_RESIDENT_STREAK);
+    if (takeResident) {
+        process = resident.front();
+        resident.pop_front();
+        residentStreak = swappedOut.empty() ? 0 : residentStreak + 1;
+    }
+    else {
+        process = swappedOut.front();
+        swappedOut.pop_front();
+        residentStreak = 0;
+    }
+}
+
+std::vector<Process*> ReadyQueue::peekSwappedOut(size_t count) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    size_t n = std::min(count, swappedOut.size());
+    return std::vector<Process*>(swappedOut.begin(), swappedOut.begin() + n);
+}
+
+void ReadyQueue::promoteResident(size_t count) {
+    std::lock_guard<std::mutex> lock(mtx);
+    size_t scanned = 0;
+    for (auto it = swappedOut.begin(); it != swappedOut.end() && scanned < count; ++scanned) {
+        if ((*it)->isInMemory()) {
+            resident.push_back(*it);
+            it = swappedOut.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+size_t ReadyQueue::getNumMemoryBlocked() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return memoryBlocked.size();
+}
+
+void ReadyQueue::stop() {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopped = true;
+    cv.notify_all();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+class Process;
+
+// Scheduler ready queue that knows about memory residency. Resident
+// processes are dispatched ahead of swapped-out ones (with a bounded number
+// of bypasses so the latter still get their turn), and processes that could
+// not get memory wait in a separate list until memory is released instead of
+// cycling through the dispatcher.
+class ReadyQueue {
+public:
+    ReadyQueue();
+
+    void push(Process* process);
+    void pushMemoryBlocked(Process* process);
+    // Memory was released; blocked processes get another chance at admission
+    void wakeMemoryBlocked();
+    // The process was brought into memory; it is ready again if it was blocked
+    void wakeMemoryBlocked(Process* process);
+
+    // Blocks until a process is ready. Returns false once stopped and empty.
+    bool waitAndPop(Process*& process);
+
+    // The swapped-out processes nearest the head, which are dispatched next
+    std::vector<Process*> peekSwappedOut(size_t count) const;
+    // Moves processes near the head of the swapped-out list that have since
+    // been brought into memory over to the resident list
+    void promoteResident(size_t count);
+
+    size_t getNumMemoryBlocked() const;
+    void stop();
+
+private:
+    void popLocked(Process*& process);
+
+    mutable std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<Process*> resident;
+    std::deque<Process*> swappedOut;
+    std::deque<Process*> memoryBlocked;
+    unsigned int residentStreak;
+    bool stopped;
+};
@@ -6,6 +6,7 @@
 #include <atomic>
 #include <condition_variable>
 #include "Process.h"
+#include "ProcessRegistry.h"
 
 class Process;
 
@@ -21,12 +22,21 @@ public:
     virtual bool isPaused() const;
 
     virtual int getTotalCores() const = 0;
+    // Processes on a core, as of the latest snapshot
     virtual int getBusyCores() const = 0;
 
+    // One consistent view of the running, queued and finished processes.
+    // Cheap to take repeatedly; monitoring commands should read this rather
+    // than the separate lists below.
+    virtual std::shared_ptr<const SchedulerSnapshot> getSnapshot() const = 0;
+
     virtual std::map<Process*, int> getRunningProcesses() const = 0;
     virtual std::vector<Process*> getQueuedProcesses() const = 0;
     virtual std::vector<Process*> getFinishedProcesses() const = 0;
 
+    // Removes finished processes from the scheduler so they can be retired
+    virtual std::vector<Process*> takeFinishedProcesses() = 0;
+
 protected:
     std::atomic<bool> running{ false };
     std::atomic<bool> paused{ false };
@@ -1,39 +1,69 @@
 #include "Command.h"
 #include "Config.h"
 #include "SchedulerFirstComeFirstServe.h"
-#include <algorithm>
 #include <iostream>
 #include <thread>
 
+// Swapped-out processes at the head of the ready queue that are swapped in ahead of dispatch
+static const size_t PREFETCH_DEPTH = 2;
+
 SchedulerFirstComeFirstServe::SchedulerFirstComeFirstServe(int numCores, ConsoleManager& manager)
-	: numCores(numCores), running(false), paused(false), consoleManager(manager), cpuCycles(0) {
+	: numCores(numCores), consoleManager(manager), cpuCycles(0) {
 
 	for (int i = 0; i < numCores; ++i) {
 		Worker* worker = new Worker();
 		worker->coreId = i;
 		workers.push_back(worker);
 	}
+	// A process parked while its image was swapped in is ready as soon as it arrives
+	consoleManager.getMemoryManager().setSwapInListener([this](Process* process) {
+		processQueue.wakeMemoryBlocked(process);
+	});
 }
 
 SchedulerFirstComeFirstServe::~SchedulerFirstComeFirstServe() {
 	stop();
+	consoleManager.getMemoryManager().setSwapInListener(nullptr);
 	for (Worker* worker : workers) {
 		delete worker;
 	}
 }
 
 void SchedulerFirstComeFirstServe::addProcess(Process* process) {
-	{
-		std::lock_guard<std::mutex> lock(queuedProcessesMutex);
-		if (queuedProcessesSet.find(process) == queuedProcessesSet.end()) {
-			queuedProcessesSet.insert(process);
-			processQueue.push(process);
+	if (registry.enqueue(process)) {
+		process->onReady(consoleManager.getCpuCycles());
+		processQueue.push(process);
+	}
+}
+
+void SchedulerFirstComeFirstServe::blockOnMemory(Process* process) {
+	if (registry.enqueue(process)) {
+		process->onMemoryBlocked(consoleManager.getCpuCycles());
+		processQueue.pushMemoryBlocked(process);
+	}
+}
+
+void SchedulerFirstComeFirstServe::prefetchSwapIns() {
+	MemoryManager& memoryManager = consoleManager.getMemoryManager();
+	for (Process* process : processQueue.peekSwappedOut(PREFETCH_DEPTH)) {
+		if (!memoryManager.prefetchMemory(process)) {
+			break;
 		}
 	}
-	{
-		std::lock_guard<std::mutex> lock(allProcessesMutex);
-		if (std::find(allProcesses.begin(), allProcesses.end(), process) == allProcesses.end()) {
-			allProcesses.push_back(process);
+	processQueue.promoteResident(PREFETCH_DEPTH);
+}
+
+void SchedulerFirstComeFirstServe::stop() {
+	if (!running.load()) return;
+	processQueue.stop();
+	Scheduler::stop();
+	for (Worker* worker : workers) {
+		{
+			std::lock_guard<std::mutex> lock(worker->mtx);
+		}
+		worker->cv.notify_all();
+		if (worker->thread.joinable()) {
+			worker->thread.join();
 		}
 	}
 }
@@ -54,21 +84,17 @@ void SchedulerFirstComeFirstServe::schedulerLoop() {
 		if (!running.load()) break;
 
 		Process* process = nullptr;
-		if (processQueue.wait_and_pop(process)) {
+		if (processQueue.waitAndPop(process)) {
 			if (!running.load()) break;
 
-			// Remove from queuedProcessesSet
-			{
-				std::lock_guard<std::mutex> lock(queuedProcessesMutex);
-				queuedProcessesSet.erase(process);
-			}
+			registry.dequeue(process);
 
 			if (!process->isInMemory()) {
 				// Process is not in memory, cannot schedule it
 				// Try to allocate memory again
 				if (!consoleManager.getMemoryManager().allocateMemory(process, process->getMemorySize())) {
-					// Requeue the process
-					addProcess(process);
+					// Wait for memory instead of cycling through the ready queue
+					blockOnMemory(process);
 					continue;
 				}
 			}
@@ -81,6 +107,8 @@ void SchedulerFirstComeFirstServe::schedulerLoop() {
 					if (!worker->busy.load()) {
 						worker->currentProcess = process;
 						worker->busy.store(true);
+						registry.dispatch(process, worker->coreId);
+						process->onDispatch(consoleManager.getCpuCycles(), worker->coreId);
 						worker->cv.notify_one();
 						assigned = true;
 						break;
@@ -92,6 +120,9 @@ void SchedulerFirstComeFirstServe::schedulerLoop() {
 					consoleManager.getMemoryManager().incrementIdleCpuTicks();
 				}
 			}
+
+			// Overlap the next swap-ins with this process's run
+			prefetchSwapIns();
 		}
 	}
 }
@@ -127,6 +158,7 @@ void SchedulerFirstComeFirstServe::workerLoop(int coreId) {
 
 		Process* process = worker->currentProcess;
 		lock.unlock();
+		consoleManager.getMemoryManager().onProcessDispatched(process, coreId);
 
 		// Check if process is in memory before executing
 		if (!process->isInMemory()) {
@@ -138,7 +170,8 @@ void SchedulerFirstComeFirstServe::workerLoop(int coreId) {
 				worker->currentProcess = nullptr;
 				lock.unlock();
 
-				addProcess(process);
+				consoleManager.getMemoryManager().onProcessDescheduled(process);
+				blockOnMemory(process);
 				continue;
 			}
 		}
@@ -150,8 +183,9 @@ void SchedulerFirstComeFirstServe::workerLoop(int coreId) {
 				// Lost memory allocation, need to requeue
 				if (!consoleManager.getMemoryManager().allocateMemory(process, process->getMemorySize())) {
 					// Put command back and requeue process
-					process->addCommand(cmd);
-					addProcess(process);
+					process->returnCommand();
+					consoleManager.getMemoryManager().onProcessDescheduled(process);
+					blockOnMemory(process);
 
 					// Reset worker state
 					lock.lock();
@@ -177,8 +211,9 @@ void SchedulerFirstComeFirstServe::workerLoop(int coreId) {
 			consoleManager.getMemoryManager().incrementActiveCpuTicks();
 
 			// Execute instruction
+			// Fetching the instruction touches its page
+			consoleManager.getMemoryManager().accessMemory(process, process->getInstructionAddress(), false, coreId);
 			cmd->execute(process, coreId);
-			delete cmd;
 
 			process->incrementCurrentLine();
 
@@ -189,19 +224,32 @@ void SchedulerFirstComeFirstServe::workerLoop(int coreId) {
 			}
 		}
 
-		if (!running.load()) break;
+		if (!running.load()) {
+			break;
+		}
 
 		// Only deallocate memory and mark process as completed if we finished all instructions
-		if (process->getNextCommand() == nullptr) {
+		// (a non-null command means the process was requeued after losing its memory)
+		bool processCompleted = false;
+		if (cmd == nullptr) {
 			process->setCompleted(true);
+			process->onComplete(consoleManager.getCpuCycles());
 			process->log("Process finished execution.", coreId);
-			consoleManager.getMemoryManager().deallocateMemory(process);
+			consoleManager.getMemoryManager().deallocateMemory(process, coreId);
+			consoleManager.getMemoryManager().onProcessDescheduled(process);
+			processQueue.wakeMemoryBlocked();
+			processCompleted = true;
 		}
 
 		lock.lock();
 		worker->busy.store(false);
 		worker->currentProcess = nullptr;
 		lock.unlock();
+
+		// Hand the process over only once this core no longer touches it, so it can be retired
+		if (processCompleted) {
+			registry.finish(process);
+		}
 	}
 }
 
@@ -210,44 +258,35 @@ int SchedulerFirstComeFirstServe::getTotalCores() const {
 }
 
 int SchedulerFirstComeFirstServe::getBusyCores() const {
-	int busyCores = 0;
-	for (const Worker* worker : workers) {
-		if (worker->busy.load() && worker->currentProcess != nullptr && worker->currentProcess->isInMemory()) {
-			busyCores++;
-		}
-	}
-	return busyCores;
+	// From the registry, so it agrees with the snapshot's running list
+	return static_cast<int>(registry.getSnapshot()->running.size());
+}
+
+std::shared_ptr<const SchedulerSnapshot> SchedulerFirstComeFirstServe::getSnapshot() const {
+	return registry.getSnapshot();
 }
 
 std::map<Process*, int> SchedulerFirstComeFirstServe::getRunningProcesses() const {
-	std::map<Process*, int> runningProcesses;
-	for (const Worker* worker : workers) {
-		if (worker->currentProcess != nullptr && worker->currentProcess->isInMemory()) {
-			runningProcesses[worker->currentProcess] = worker->coreId;
+	std::map<Process*, int> runningProcesses = registry.getRunning();
+	for (auto it = runningProcesses.begin(); it != runningProcesses.end(); ) {
+		if (!it->first->isInMemory()) {
+			it = runningProcesses.erase(it);
+		}
+		else {
+			++it;
 		}
 	}
 	return runningProcesses;
 }
 
 std::vector<Process*> SchedulerFirstComeFirstServe::getQueuedProcesses() const {
-	std::vector<Process*> queuedProcesses;
-	{
-		std::lock_guard<std::mutex> lock(queuedProcessesMutex);
-		for (auto process : queuedProcessesSet) {
-			queuedProcesses.push_back(process);
-		}
-	}
-	return queuedProcesses;
+	return registry.getQueued();
 }
 
 std::vector<Process*> SchedulerFirstComeFirstServe::getFinishedProcesses() const {
-	std::vector<Process*> finishedProcesses;
-	std::lock_guard<std::mutex> lock(allProcessesMutex);
-	auto runningProcesses = getRunningProcesses();
-	for (Process* process : allProcesses) {
-		if (process->isCompleted() && runningProcesses.find(process) == runningProcesses.end()) {
-			finishedProcesses.push_back(process);
-		}
-	}
-	return finishedProcesses;
+	return registry.getFinished();
+}
+
+std::vector<Process*> SchedulerFirstComeFirstServe::takeFinishedProcesses() {
+	return registry.takeFinished();
 }
\ No newline at end of file
@@ -1,39 +1,69 @@
 #include "Command.h"
 #include "Config.h"
 #include "SchedulerRoundRobin.h"
-#include <algorithm>
 #include <iostream>
 #include <thread>
 
+// Swapped-out processes at the head of the ready queue that are swapped in ahead of dispatch
+static const size_t PREFETCH_DEPTH = 2;
+
 SchedulerRoundRobin::SchedulerRoundRobin(int numCores, unsigned int quantum, ConsoleManager& manager)
-	: numCores(numCores), quantum(quantum), running(false), paused(false), consoleManager(manager), cpuCycles(0) {
+	: numCores(numCores), quantum(quantum), consoleManager(manager), cpuCycles(0) {
 
 	for (int i = 0; i < numCores; ++i) {
 		Worker* worker = new Worker();
 		worker->coreId = i;
 		workers.push_back(worker);
 	}
+	// A process parked while its image was swapped in is ready as soon as it arrives
+	consoleManager.getMemoryManager().setSwapInListener([this](Process* process) {
+		processQueue.wakeMemoryBlocked(process);
+	});
 }
 
 SchedulerRoundRobin::~SchedulerRoundRobin() {
 	stop();
+	consoleManager.getMemoryManager().setSwapInListener(nullptr);
 	for (Worker* worker : workers) {
 		delete worker;
 	}
 }
 
 void SchedulerRoundRobin::addProcess(Process* process) {
-	{
-		std::lock_guard<std::mutex> lock(queuedProcessesMutex);
-		if (queuedProcessesSet.find(process) == queuedProcessesSet.end()) {
-			queuedProcessesSet.insert(process);
-			processQueue.push(process);
+	if (registry.enqueue(process)) {
+		process->onReady(consoleManager.getCpuCycles());
+		processQueue.push(process);
+	}
+}
+
+void SchedulerRoundRobin::blockOnMemory(Process* process) {
+	if (registry.enqueue(process)) {
+		process->onMemoryBlocked(consoleManager.getCpuCycles());
+		processQueue.pushMemoryBlocked(process);
+	}
+}
+
+void SchedulerRoundRobin::prefetchSwapIns() {
+	MemoryManager& memoryManager = consoleManager.getMemoryManager();
+	for (Process* process : processQueue.peekSwappedOut(PREFETCH_DEPTH)) {
+		if (!memoryManager.prefetchMemory(process)) {
+			break;
 		}
 	}
-	{
-		std::lock_guard<std::mutex> lock(allProcessesMutex);
-		if (std::find(allProcesses.begin(), allProcesses.end(), process) == allProcesses.end()) {
-			allProcesses.push_back(process);
+	processQueue.promoteResident(PREFETCH_DEPTH);
+}
+
+void SchedulerRoundRobin::stop() {
+	if (!running.load()) return;
+	processQueue.stop();
+	Scheduler::stop();
+	for (Worker* worker : workers) {
+		{
+			std::lock_guard<std::mutex> lock(worker->mtx);
+		}
+		worker->cv.notify_all();
+		if (worker->thread.joinable()) {
+			worker->thread.join();
 		}
 	}
 }
@@ -54,21 +84,17 @@ void SchedulerRoundRobin::schedulerLoop() {
 		if (!running.load()) break;
 
 		Process* process = nullptr;
-		if (processQueue.wait_and_pop(process)) {
+		if (processQueue.waitAndPop(process)) {
 			if (!running.load()) break;
 
-			// Remove from queuedProcessesSet
-			{
-				std::lock_guard<std::mutex> lock(queuedProcessesMutex);
-				queuedProcessesSet.erase(process);
-			}
+			registry.dequeue(process);
 
 			if (!process->isInMemory()) {
 				// Process is not in memory, cannot schedule it
 				// Try to allocate memory again
 				if (!consoleManager.getMemoryManager().allocateMemory(process, process->getMemorySize())) {
-					// Requeue the process
-					addProcess(process);
+					// Wait for memory instead of cycling through the ready queue
+					blockOnMemory(process);
 					continue;
 				}
 			}
@@ -81,6 +107,8 @@ void SchedulerRoundRobin::schedulerLoop() {
 					if (!worker->busy.load()) {
 						worker->currentProcess = process;
 						worker->busy.store(true);
+						registry.dispatch(process, worker->coreId);
+						process->onDispatch(consoleManager.getCpuCycles(), worker->coreId);
 						worker->remainingQuantum = quantum;
 						worker->cv.notify_one();
 						assigned = true;
@@ -93,6 +121,9 @@ void SchedulerRoundRobin::schedulerLoop() {
 					consoleManager.getMemoryManager().incrementIdleCpuTicks();
 				}
 			}
+
+			// Overlap the next swap-ins with this process's run
+			prefetchSwapIns();
 		}
 	}
 }
@@ -130,6 +161,7 @@ void SchedulerRoundRobin::workerLoop(int coreId) {
 		unsigned int timeSlice = worker->remainingQuantum;
 
 		lock.unlock();
+		consoleManager.getMemoryManager().onProcessDispatched(process, coreId);
 
 		// Check if process is in memory before starting execution
 		if (!process->isInMemory()) {
@@ -142,12 +174,14 @@ void SchedulerRoundRobin::workerLoop(int coreId) {
 				lock.unlock();
 
 				process->log("Process requeued due to insufficient memory.", coreId);
-				addProcess(process);
+				consoleManager.getMemoryManager().onProcessDescheduled(process);
+				blockOnMemory(process);
 				continue;
 			}
 		}
 
 		bool processCompleted = false;
+		bool requeued = false;
 		Command* lastCommand = nullptr;
 
 		while (timeSlice > 0 && running.load()) {
@@ -167,9 +201,11 @@ void SchedulerRoundRobin::workerLoop(int coreId) {
 					process->log("Process lost memory allocation, requeueing.", coreId);
 					if (lastCommand != nullptr) {
 						// Re-add the last command that couldn't be executed
-						process->addCommand(lastCommand);
+						process->returnCommand();
 					}
-					addProcess(process);
+					consoleManager.getMemoryManager().onProcessDescheduled(process);
+					blockOnMemory(process);
+					requeued = true;
 
 					// Reset worker state
 					lock.lock();
@@ -188,8 +224,9 @@ void SchedulerRoundRobin::workerLoop(int coreId) {
 			if (cmd == nullptr) {
 				// Process is done; deallocate memory
 				process->setCompleted(true);
+				process->onComplete(consoleManager.getCpuCycles());
 				process->log("Process finished execution.", coreId);
-				consoleManager.getMemoryManager().deallocateMemory(process);
+				consoleManager.getMemoryManager().deallocateMemory(process, coreId);
 				processCompleted = true;
 				break;
 			}
@@ -199,8 +236,9 @@ void SchedulerRoundRobin::workerLoop(int coreId) {
 			cpuCycles++;
 			consoleManager.getMemoryManager().incrementActiveCpuTicks();
 
+			// Fetching the instruction touches its page
+			consoleManager.getMemoryManager().accessMemory(process, process->getInstructionAddress(), false, coreId);
 			cmd->execute(process, coreId);
-			delete cmd;
 			lastCommand = nullptr;
 
 			process->incrementCurrentLine();
@@ -218,15 +256,27 @@ void SchedulerRoundRobin::workerLoop(int coreId) {
 
 		if (!running.load()) break;
 
+		if (!requeued) {
+			// Descheduled before it can be requeued, so another core's dispatch is not undone
+			consoleManager.getMemoryManager().onProcessDescheduled(process);
+			// Freed or now-evictable memory may admit a blocked process
+			processQueue.wakeMemoryBlocked();
+		}
+
 		lock.lock();
 		worker->busy.store(false);
 		worker->currentProcess = nullptr;
 		worker->remainingQuantum = 0;
 		lock.unlock();
 
-		if (!processCompleted && !process->isCompleted()) {
+		if (processCompleted) {
+			// Hand the process over only once this core no longer touches it, so it can be retired
+			registry.finish(process);
+		}
+		else if (!requeued) {
 			// Process still has work to do, requeue it
 			process->log("Process quantum expired, requeueing.", coreId);
+			process->onPreempt(consoleManager.getCpuCycles());
 			addProcess(process);
 		}
 	}
@@ -237,44 +287,35 @@ int SchedulerRoundRobin::getTotalCores() const {
 }
 
 int SchedulerRoundRobin::getBusyCores() const {
-	int busyCores = 0;
-	for (const Worker* worker : workers) {
-		if (worker->busy.load() && worker->currentProcess != nullptr && worker->currentProcess->isInMemory()) {
-			busyCores++;
-		}
-	}
-	return busyCores;
+	// From the registry, so it agrees with the snapshot's running list
+	return static_cast<int>(registry.getSnapshot()->running.size());
+}
+
+std::shared_ptr<const SchedulerSnapshot> SchedulerRoundRobin::getSnapshot() const {
+	return registry.getSnapshot();
 }
 
 std::map<Process*, int> SchedulerRoundRobin::getRunningProcesses() const {
-	std::map<Process*, int> runningProcesses;
-	for (const Worker* worker : workers) {
-		if (worker->currentProcess != nullptr && worker->currentProcess->isInMemory()) {
-			runningProcesses[worker->currentProcess] = worker->coreId;
+	std::map<Process*, int> runningProcesses = registry.getRunning();
+	for (auto it = runningProcesses.begin(); it != runningProcesses.end(); ) {
+		if (!it->first->isInMemory()) {
+			it = runningProcesses.erase(it);
+		}
+		else {
+			++it;
 		}
 	}
 	return runningProcesses;
 }
 
 std::vector<Process*> SchedulerRoundRobin::getQueuedProcesses() const {
-	std::vector<Process*> queuedProcesses;
-	{
-		std::lock_guard<std::mutex> lock(queuedProcessesMutex);
-		for (auto process : queuedProcessesSet) {
-			queuedProcesses.push_back(process);
-		}
-	}
-	return queuedProcesses;
+	return registry.getQueued();
 }
 
 std::vector<Process*> SchedulerRoundRobin::getFinishedProcesses() const {
-	std::vector<Process*> finishedProcesses;
-	std::lock_guard<std::mutex> lock(allProcessesMutex);
-	auto runningProcesses = getRunningProcesses();
-	for (Process* process : allProcesses) {
-		if (process->isCompleted() && runningProcesses.find(process) == runningProcesses.end()) {
-			finishedProcesses.push_back(process);
-		}
-	}
-	return finishedProcesses;
+	return registry.getFinished();
+}
+
+std::vector<Process*> SchedulerRoundRobin::takeFinishedProcesses() {
+	return registry.takeFinished();
 }
\ No newline at end of file
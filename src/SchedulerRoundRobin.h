@@ -2,13 +2,13 @@
 
 #include "ConsoleManager.h"
 #include "Process.h"
+#include "ProcessRegistry.h"
+#include "ReadyQueue.h"
 #include "Scheduler.h"
-#include "ThreadSafeQueue.h"
 #include <atomic>
 #include <condition_variable>
 #include <map>
 #include <thread>
-#include <unordered_set>
 #include <vector>
 
 class SchedulerRoundRobin : public Scheduler {
@@ -17,29 +17,28 @@ public:
 	~SchedulerRoundRobin();
 
 	void addProcess(Process* process) override;
+	void stop() override;
 	int getTotalCores() const override;
 	int getBusyCores() const override;
+	std::shared_ptr<const SchedulerSnapshot> getSnapshot() const override;
 
 	std::map<Process*, int> getRunningProcesses() const override;
 	std::vector<Process*> getQueuedProcesses() const override;
 	std::vector<Process*> getFinishedProcesses() const override;
+	std::vector<Process*> takeFinishedProcesses() override;
 
 private:
 	void schedulerLoop() override;
 	void workerLoop(int coreId);
+	// Parks a process that could not get memory until memory is released
+	void blockOnMemory(Process* process);
+	// Swaps in the next swapped-out processes in line while memory is free
+	void prefetchSwapIns();
 
 	int numCores;
 	unsigned int quantum;
 
-	std::vector<std::thread> workerThreads;
-	std::thread schedulerThread;
-
-	ThreadSafeQueue<Process*> processQueue;
-
-	std::atomic<bool> running;
-	std::atomic<bool> paused;
-	std::mutex pauseMutex;
-	std::condition_variable pauseCV;
+	ReadyQueue processQueue;
 
 	struct Worker {
 		int coreId = 0;
@@ -55,11 +54,7 @@ private:
 
 	ConsoleManager& consoleManager;
 
-	std::vector<Process*> allProcesses;
-	mutable std::mutex allProcessesMutex;
+	ProcessRegistry registry;
 
 	std::atomic<unsigned int> cpuCycles;
-
-	std::unordered_set<Process*> queuedProcessesSet;
-	mutable std::mutex queuedProcessesMutex;
 };
\ No newline at end of file
@@ -76,8 +76,8 @@ void Screen::displayProcessScreen() {
         Scheduler* scheduler = consoleManager.getScheduler();
         bool isRunning = false;
         if (scheduler) {
-            auto runningProcesses = scheduler->getRunningProcesses();
-            if (runningProcesses.find(process) != runningProcesses.end()) {
+            std::shared_ptr<const SchedulerSnapshot> snapshot = scheduler->getSnapshot();
+            if (snapshot->running.find(process) != snapshot->running.end()) {
                 isRunning = true;
             }
         }
@@ -118,4 +118,27 @@ void Screen::displayProcessScreen() {
         std::cout << "Progress: " << std::fixed << std::setprecision(2) << progress << "%\n";
         std::cout << "Status: " << status << "\n\n";
     }
+
+    ProcessMetrics metrics = process->getMetrics(consoleManager.getCpuCycles());
+
+    auto printTiming = [](const std::string& label, unsigned int cycles, double ms) {
+        std::cout << "  " << std::left << std::setw(17) << label << ": "
+            << cycles << " cycles (" << std::fixed << std::setprecision(2) << ms << " ms)\n";
+    };
+
+    std::cout << "Scheduling metrics:\n";
+    if (metrics.dispatched) {
+        printTiming("Response time", metrics.getResponseCycles(), metrics.responseMs);
+    }
+    else {
+        std::cout << "  " << std::left << std::setw(17) << "Response time" << ": not dispatched yet\n";
+    }
+    printTiming("Waiting time", metrics.waitingCycles, metrics.waitingMs);
+    printTiming("Run time", metrics.runCycles, metrics.runMs);
+    printTiming("Memory blocked", metrics.memoryBlockedCycles, metrics.memoryBlockedMs);
+    if (metrics.completed) {
+        printTiming("Turnaround time", metrics.getTurnaroundCycles(), metrics.turnaroundMs);
+    }
+    std::cout << "  " << std::left << std::setw(17) << "Preemptions" << ": " << metrics.preemptions << "\n";
+    std::cout << "  " << std::left << std::setw(17) << "Core migrations" << ": " << metrics.migrations << "\n\n";
 }
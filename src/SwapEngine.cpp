@@ -0,0 +1,155 @@
+#include "SwapEngine.h"
+#include <algorithm>
+
+// Latency samples kept for the percentiles
+static const size_t LATENCY_SAMPLES = 1024;
+
+SwapEngine::SwapEngine()
+    : stopping(false), latencyUs(0), bandwidthMBps(0), maxQueueDepth(0), nextLatency(0), numReads(0), numWrites(0) {}
+
+SwapEngine::~SwapEngine() {
+    stop();
+}
+
+void SwapEngine::configure(unsigned int numThreads, unsigned int latencyUs, unsigned int bandwidthMBps) {
+    stop();
+    std::lock_guard<std::mutex> lock(mutex);
+    this->latencyUs = latencyUs;
+    this->bandwidthMBps = bandwidthMBps;
+    stopping = false;
+    for (unsigned int i = 0; i < numThreads; ++i) {
+        threads.emplace_back(&SwapEngine::ioLoop, this);
+    }
+}
+
+void SwapEngine::stop() {
+    std::vector<std::thread> stopped;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+        stopped.swap(threads);
+    }
+    cv.notify_all();
+    for (std::thread& thread : stopped) {
+        thread.join();
+    }
+}
+
+bool SwapEngine::isAsync() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !threads.empty();
+}
+
+std::chrono::microseconds SwapEngine::serviceTime(unsigned int bytes) const {
+    // A megabyte per second moves one byte per microsecond
+    uint64_t transferUs = bandwidthMBps > 0 ? bytes / bandwidthMBps : 0;
+    return std::chrono::microseconds(latencyUs + transferUs);
+}
+
+void SwapEngine::submit(Process* process, SwapDirection direction, unsigned int bytes, std::function<void()> transfer) {
+    Request request{ process, direction, bytes, std::move(transfer), std::chrono::steady_clock::now() };
+    std::chrono::microseconds service;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!threads.empty()) {
+            queue.push_back(std::move(request));
+            maxQueueDepth = std::max(maxQueueDepth, static_cast<unsigned int>(queue.size() + inService.size()));
+            cv.notify_one();
+            return;
+        }
+        service = serviceTime(bytes);
+    }
+
+    // Synchronous: the submitting thread waits out the device itself
+    if (service.count() > 0) {
+        std::this_thread::sleep_for(service);
+    }
+    request.transfer();
+    complete(request);
+}
+
+void SwapEngine::ioLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        // The oldest request whose process has nothing ahead of it in service or in the queue
+        auto next = queue.end();
+        std::set<Process*> waiting = inService;
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (waiting.insert(it->process).second) {
+                next = it;
+                break;
+            }
+        }
+        if (next == queue.end()) {
+            if (stopping) {
+                return;
+            }
+            cv.wait(lock);
+            continue;
+        }
+
+        Request request = std::move(*next);
+        queue.erase(next);
+        inService.insert(request.process);
+        std::chrono::microseconds service = serviceTime(request.bytes);
+        lock.unlock();
+
+        if (service.count() > 0) {
+            std::this_thread::sleep_for(service);
+        }
+        request.transfer();
+        complete(request);
+
+        lock.lock();
+        inService.erase(request.process);
+        // The process's next request may now be taken
+        cv.notify_all();
+    }
+}
+
+void SwapEngine::complete(const Request& request) {
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - request.submitted).count();
+    if (request.direction == SwapDirection::In) {
+        numReads++;
+    }
+    else {
+        numWrites++;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    uint32_t sample = static_cast<uint32_t>(std::min<long long>(latency, UINT32_MAX));
+    if (latencies.size() < LATENCY_SAMPLES) {
+        latencies.push_back(sample);
+    }
+    else {
+        latencies[nextLatency] = sample;
+        nextLatency = (nextLatency + 1) % LATENCY_SAMPLES;
+    }
+}
+
+SwapIoStats SwapEngine::getStats() const {
+    SwapIoStats stats;
+    std::vector<uint32_t> sorted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.threads = static_cast<unsigned int>(threads.size());
+        stats.latencyUs = latencyUs;
+        stats.bandwidthMBps = bandwidthMBps;
+        stats.queueDepth = static_cast<unsigned int>(queue.size() + inService.size());
+        stats.maxQueueDepth = maxQueueDepth;
+        sorted = latencies;
+    }
+    stats.reads = numReads;
+    stats.writes = numWrites;
+    if (!sorted.empty()) {
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double fraction) {
+            return static_cast<double>(sorted[static_cast<size_t>(fraction * (sorted.size() - 1))]);
+        };
+        stats.p50Us = percentile(0.50);
+        stats.p95Us = percentile(0.95);
+        stats.p99Us = percentile(0.99);
+    }
+    return stats;
+}
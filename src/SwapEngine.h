@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+class Process;
+
+enum class SwapDirection { In, Out };
+
+struct SwapIoStats {
+    unsigned int threads = 0;           // 0: requests run on the thread that submits them
+    unsigned int latencyUs = 0;
+    unsigned int bandwidthMBps = 0;     // 0: unlimited
+    unsigned int queueDepth = 0;        // Queued plus in service
+    unsigned int maxQueueDepth = 0;
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+    double p50Us = 0.0;                 // Submission to completion, over recent requests
+    double p95Us = 0.0;
+    double p99Us = 0.0;
+};
+
+// Swap device for whole-process swapping. Requests wait in one queue for a
+// pool of I/O threads; each takes the device latency plus its size over the
+// bandwidth before its transfer runs. Requests for the same process complete
+// in the order they were submitted.
+class SwapEngine {
+public:
+    SwapEngine();
+    ~SwapEngine();
+
+    // Restarts the engine; requests still queued are dropped
+    void configure(unsigned int numThreads, unsigned int latencyUs, unsigned int bandwidthMBps);
+    void stop();
+    bool isAsync() const;
+
+    // Without I/O threads the transfer runs before submit returns, after the
+    // caller has waited out the service time. Callers submit while holding
+    // their own locks; in that mode the device is meant to stall them, as a
+    // swapper with no I/O of its own would.
+    void submit(Process* process, SwapDirection direction, unsigned int bytes, std::function<void()> transfer);
+
+    SwapIoStats getStats() const;
+
+private:
+    struct Request {
+        Process* process;
+        SwapDirection direction;
+        unsigned int bytes;
+        std::function<void()> transfer;
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    void ioLoop();
+    // Service time of the modeled device
+    std::chrono::microseconds serviceTime(unsigned int bytes) const;
+    void complete(const Request& request);
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Request> queue;
+    std::set<Process*> inService;       // A process's next request waits for these
+    std::vector<std::thread> threads;
+    bool stopping;
+    unsigned int latencyUs;
+    unsigned int bandwidthMBps;
+    unsigned int maxQueueDepth;
+
+    // Recent latencies in microseconds, overwritten round robin
+    std::vector<uint32_t> latencies;
+    size_t nextLatency;
+    std::atomic<uint64_t> numReads;
+    std::atomic<uint64_t> numWrites;
+};
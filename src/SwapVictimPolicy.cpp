@@ -0,0 +1,133 @@
+#include "SwapVictimPolicy.h"
+
+SwapVictimPolicy::SwapVictimPolicy() : clock(0) {}
+
+SwapVictimPolicy* SwapVictimPolicy::create(const std::string& name) {
+    if (name == "fifo") {
+        return new FifoSwapVictimPolicy();
+    }
+    else if (name == "lru") {
+        return new LruSwapVictimPolicy();
+    }
+    else if (name == "smallest-fit") {
+        return new SmallestFitSwapVictimPolicy();
+    }
+    return nullptr;
+}
+
+void SwapVictimPolicy::onAdmit(Process* process, size_t size) {
+    if (residents.count(process) > 0) {
+        return;
+    }
+    ++clock;
+    Resident& resident = residents[process];
+    resident = { size, clock, clock };
+    if (running.count(process) == 0) {
+        addCandidate(process, resident);
+    }
+}
+
+void SwapVictimPolicy::onRemove(Process* process) {
+    auto it = residents.find(process);
+    if (it == residents.end()) {
+        return;
+    }
+    if (running.count(process) == 0) {
+        removeCandidate(process, it->second);
+    }
+    residents.erase(it);
+}
+
+void SwapVictimPolicy::onDispatch(Process* process) {
+    if (!running.insert(process).second) {
+        return;
+    }
+    auto it = residents.find(process);
+    if (it != residents.end()) {
+        removeCandidate(process, it->second);
+        it->second.lastDispatch = ++clock;
+    }
+}
+
+void SwapVictimPolicy::onDeschedule(Process* process) {
+    if (running.erase(process) == 0) {
+        return;
+    }
+    auto it = residents.find(process);
+    if (it != residents.end()) {
+        addCandidate(process, it->second);
+    }
+}
+
+template <typename Iterator>
+std::vector<Process*> SwapVictimPolicy::takeUntilCovered(Iterator begin, Iterator end, size_t bytesNeeded) const {
+    std::vector<Process*> victims;
+    size_t covered = 0;
+    for (Iterator it = begin; it != end && covered < bytesNeeded; ++it) {
+        victims.push_back(it->second);
+        covered += residents.at(it->second).size;
+    }
+    if (covered < bytesNeeded) {
+        // Swapping these out could not make room anyway
+        victims.clear();
+    }
+    return victims;
+}
+
+// FIFO
+
+std::vector<Process*> FifoSwapVictimPolicy::selectVictims(size_t bytesNeeded) {
+    return takeUntilCovered(candidates.begin(), candidates.end(), bytesNeeded);
+}
+
+std::string FifoSwapVictimPolicy::getName() const {
+    return "fifo";
+}
+
+void FifoSwapVictimPolicy::addCandidate(Process* process, const Resident& resident) {
+    candidates.insert(std::make_pair(resident.admitOrder, process));
+}
+
+void FifoSwapVictimPolicy::removeCandidate(Process* process, const Resident& resident) {
+    candidates.erase(std::make_pair(resident.admitOrder, process));
+}
+
+// LRU
+
+std::vector<Process*> LruSwapVictimPolicy::selectVictims(size_t bytesNeeded) {
+    return takeUntilCovered(candidates.begin(), candidates.end(), bytesNeeded);
+}
+
+std::string LruSwapVictimPolicy::getName() const {
+    return "lru";
+}
+
+void LruSwapVictimPolicy::addCandidate(Process* process, const Resident& resident) {
+    candidates.insert(std::make_pair(resident.lastDispatch, process));
+}
+
+void LruSwapVictimPolicy::removeCandidate(Process* process, const Resident& resident) {
+    candidates.erase(std::make_pair(resident.lastDispatch, process));
+}
+
+// Smallest fit
+
+std::vector<Process*> SmallestFitSwapVictimPolicy::selectVictims(size_t bytesNeeded) {
+    auto fit = candidates.lower_bound(std::make_pair(bytesNeeded, static_cast<Process*>(nullptr)));
+    if (fit != candidates.end()) {
+        return std::vector<Process*>(1, fit->second);
+    }
+    return takeUntilCovered(candidates.rbegin(), candidates.rend(), bytesNeeded);
+}
+
+std::string SmallestFitSwapVictimPolicy::getName() const {
+    return "smallest-fit";
+}
+
+void SmallestFitSwapVictimPolicy::addCandidate(Process* process, const Resident& resident) {
+    candidates.insert(std::make_pair(resident.size, process));
+}
+
+void SmallestFitSwapVictimPolicy::removeCandidate(Process* process, const Resident& resident) {
+    candidates.erase(std::make_pair(resident.size, process));
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class Process;
+
+// Chooses which resident processes flat memory swaps out to make room.
+// Processes currently running on a core are never candidates; every policy
+// keeps the remaining candidates in an ordered index, so admissions,
+// dispatches and removals are O(log n).
+class SwapVictimPolicy {
+public:
+    SwapVictimPolicy();
+    virtual ~SwapVictimPolicy() = default;
+
+    void onAdmit(Process* process, size_t size);
+    void onRemove(Process* process);
+    void onDispatch(Process* process);
+    void onDeschedule(Process* process);
+
+    // Victims whose sizes add up to at least bytesNeeded; empty when the
+    // candidates together cannot free that much
+    virtual std::vector<Process*> selectVictims(size_t bytesNeeded) = 0;
+    virtual std::string getName() const = 0;
+
+    static SwapVictimPolicy* create(const std::string& name);
+
+protected:
+    struct Resident {
+        size_t size;
+        uint64_t admitOrder;
+        uint64_t lastDispatch;  // Admission order until the first dispatch
+    };
+
+    virtual void addCandidate(Process* process, const Resident& resident) = 0;
+    virtual void removeCandidate(Process* process, const Resident& resident) = 0;
+
+    // Takes candidates in the given order until they cover bytesNeeded
+    template <typename Iterator>
+    std::vector<Process*> takeUntilCovered(Iterator begin, Iterator end, size_t bytesNeeded) const;
+
+    std::unordered_map<Process*, Resident> residents;
+    std::unordered_set<Process*> running;
+    uint64_t clock;
+};
+
+// Evicts in admission order
+class FifoSwapVictimPolicy : public SwapVictimPolicy {
+public:
+    std::vector<Process*> selectVictims(size_t bytesNeeded) override;
+    std::string getName() const override;
+
+protected:
+    void addCandidate(Process* process, const Resident& resident) override;
+    void removeCandidate(Process* process, const Resident& resident) override;
+
+private:
+    std::set<std::pair<uint64_t, Process*>> candidates;
+};
+
+// Evicts the processes that were dispatched longest ago
+class LruSwapVictimPolicy : public SwapVictimPolicy {
+public:
+    std::vector<Process*> selectVictims(size_t bytesNeeded) override;
+    std::string getName() const override;
+
+protected:
+    void addCandidate(Process* process, const Resident& resident) override;
+    void removeCandidate(Process* process, const Resident& resident) override;
+
+private:
+    std::set<std::pair<uint64_t, Process*>> candidates;
+};
+
+// Evicts the smallest single process that frees enough space; failing that,
+// the fewest processes by taking the largest first
+class SmallestFitSwapVictimPolicy : public SwapVictimPolicy {
+public:
+    std::vector<Process*> selectVictims(size_t bytesNeeded) override;
+    std::string getName() const override;
+
+protected:
+    void addCandidate(Process* process, const Resident& resident) override;
+    void removeCandidate(Process* process, const Resident& resident) override;
+
+private:
+    std::set<std::pair<size_t, Process*>> candidates;
+};
@@ -0,0 +1,181 @@
+#include "Tlb.h"
+#include <algorithm>
+
+Tlb::Tlb()
+    : numSets(0), associativity(0), replacement(TlbReplacement::Lru), asidTagged(true), hugePageShift(0), currentAsid(-1),
+    clock(0), randomState(0x9E3779B9u), hits(0), misses(0), flushes(0), shootdowns(0) {}
+
+void Tlb::initialize(unsigned int numEntries, unsigned int associativity, TlbReplacement replacement,
+    bool asidTagged, unsigned int hugePageShift) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->associativity = numEntries > 0 ? std::max(1u, std::min(associativity, numEntries)) : 0;
+    numSets = numEntries > 0 ? numEntries / this->associativity : 0;
+    this->replacement = replacement;
+    this->asidTagged = asidTagged;
+    this->hugePageShift = hugePageShift;
+    entries.assign(static_cast<size_t>(numSets) * this->associativity, Entry{ false, false, false, -1, -1, -1, 0 });
+    currentAsid = -1;
+    clock = 0;
+}
+
+bool Tlb::parseReplacement(const std::string& name, TlbReplacement& replacement) {
+    if (name == "lru") replacement = TlbReplacement::Lru;
+    else if (name == "fifo") replacement = TlbReplacement::Fifo;
+    else if (name == "random") replacement = TlbReplacement::Random;
+    else return false;
+    return true;
+}
+
+std::string Tlb::getReplacementName(TlbReplacement replacement) {
+    switch (replacement) {
+    case TlbReplacement::Fifo: return "fifo";
+    case TlbReplacement::Random: return "random";
+    default: return "lru";
+    }
+}
+
+std::mutex& Tlb::getMutex() {
+    return mutex;
+}
+
+Tlb::Entry* Tlb::setFor(int pageNumber, bool huge) {
+    // Huge entries are indexed by run, so one run lands in one set
+    unsigned int index = static_cast<unsigned int>(pageNumber) >> (huge ? hugePageShift : 0);
+    return &entries[(index % numSets) * associativity];
+}
+
+Tlb::Entry* Tlb::findEntry(int asid, int pageNumber, bool huge) {
+    if (huge) {
+        pageNumber &= ~((1 << hugePageShift) - 1);
+    }
+    Entry* set = setFor(pageNumber, huge);
+    for (unsigned int way = 0; way < associativity; ++way) {
+        if (set[way].valid && set[way].huge == huge && set[way].pageNumber == pageNumber && set[way].asid == asid) {
+            return &set[way];
+        }
+    }
+    return nullptr;
+}
+
+bool Tlb::lookup(int asid, int pageNumber, int& frameNumber, bool write) {
+    Entry* entry = findEntry(asid, pageNumber, false);
+    if (entry == nullptr && hugePageShift > 0) {
+        entry = findEntry(asid, pageNumber, true);
+    }
+    if (entry == nullptr || (write && !entry->writable)) {
+        misses++;
+        return false;
+    }
+    if (replacement == TlbReplacement::Lru) {
+        entry->stamp = ++clock;
+    }
+    frameNumber = entry->frameNumber;
+    hits++;
+    return true;
+}
+
+void Tlb::insert(int asid, int pageNumber, int frameNumber, bool huge, bool writable) {
+    if (huge) {
+        pageNumber &= ~((1 << hugePageShift) - 1);
+    }
+    Entry* entry = findEntry(asid, pageNumber, huge);
+    if (entry == nullptr) {
+        // An invalid way if there is one, otherwise the policy's victim
+        Entry* set = setFor(pageNumber, huge);
+        entry = std::find_if(set, set + associativity, [](const Entry& e) { return !e.valid; });
+        if (entry == set + associativity) {
+            if (replacement == TlbReplacement::Random) {
+                // xorshift32
+                randomState ^= randomState << 13;
+                randomState ^= randomState >> 17;
+                randomState ^= randomState << 5;
+                entry = &set[randomState % associativity];
+            }
+            else {
+                entry = std::min_element(set, set + associativity,
+                    [](const Entry& a, const Entry& b) { return a.stamp < b.stamp; });
+            }
+        }
+        entry->stamp = ++clock;
+    }
+    else if (replacement == TlbReplacement::Lru) {
+        entry->stamp = ++clock;
+    }
+    entry->valid = true;
+    entry->huge = huge;
+    entry->writable = writable;
+    entry->asid = asid;
+    entry->pageNumber = pageNumber;
+    entry->frameNumber = frameNumber;
+}
+
+bool Tlb::shootdown(int asid, int pageNumber, bool huge) {
+    Entry* entry = findEntry(asid, pageNumber, huge);
+    if (entry == nullptr) {
+        return false;
+    }
+    entry->valid = false;
+    shootdowns++;
+    return true;
+}
+
+void Tlb::invalidateAddressSpace(int asid) {
+    for (Entry& entry : entries) {
+        if (entry.asid == asid) {
+            entry.valid = false;
+        }
+    }
+    if (currentAsid == asid) {
+        currentAsid = -1;
+    }
+}
+
+void Tlb::writeProtectAddressSpace(int asid) {
+    for (Entry& entry : entries) {
+        if (entry.asid == asid) {
+            entry.writable = false;
+        }
+    }
+}
+
+void Tlb::switchTo(int asid) {
+    if (asid == currentAsid) {
+        return;
+    }
+    if (!asidTagged && currentAsid != -1) {
+        flush();
+    }
+    currentAsid = asid;
+}
+
+void Tlb::flush() {
+    for (Entry& entry : entries) {
+        entry.valid = false;
+    }
+    flushes++;
+}
+
+unsigned int Tlb::getNumEntries() const {
+    return static_cast<unsigned int>(entries.size());
+}
+
+unsigned int Tlb::getAssociativity() const {
+    return associativity;
+}
+
+TlbReplacement Tlb::getReplacement() const {
+    return replacement;
+}
+
+bool Tlb::isAsidTagged() const {
+    return asidTagged;
+}
+
+TlbStats Tlb::getStats() const {
+    TlbStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.flushes = flushes;
+    stats.shootdowns = shootdowns;
+    return stats;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class TlbReplacement { Lru, Fifo, Random };
+
+struct TlbStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t flushes = 0;
+    uint64_t shootdowns = 0;
+};
+
+// One core's translation lookaside buffer: a set-associative cache of
+// (address space, page) -> frame translations. A huge-page entry covers an
+// aligned run of 2^hugePageShift pages.
+// Callers hold getMutex() around lookups, inserts and invalidations; a core
+// keeps it across a hit and the word transfer that follows, so a shootdown
+// from an evicting core waits until the page is no longer in use.
+class Tlb {
+public:
+    Tlb();
+
+    // numEntries of 0 disables the TLB; associativity is clamped to numEntries
+    void initialize(unsigned int numEntries, unsigned int associativity, TlbReplacement replacement,
+        bool asidTagged, unsigned int hugePageShift = 0);
+
+    static bool parseReplacement(const std::string& name, TlbReplacement& replacement);
+    static std::string getReplacementName(TlbReplacement replacement);
+
+    std::mutex& getMutex();
+
+    // frameNumber is the frame the page, or the huge page holding it, starts at.
+    // A write to a read-only translation misses, so the page table sees it.
+    bool lookup(int asid, int pageNumber, int& frameNumber, bool write = false);
+    void insert(int asid, int pageNumber, int frameNumber, bool huge = false, bool writable = true);
+    // Drops one translation because its page left memory; returns true if it was cached here
+    bool shootdown(int asid, int pageNumber, bool huge = false);
+    // Drops every translation of an address space that no longer exists
+    void invalidateAddressSpace(int asid);
+    // Makes every translation of an address space read-only, as when its frames become shared
+    void writeProtectAddressSpace(int asid);
+    // Dispatch of an address space on this core; untagged TLBs flush when it changes
+    void switchTo(int asid);
+
+    unsigned int getNumEntries() const;
+    unsigned int getAssociativity() const;
+    TlbReplacement getReplacement() const;
+    bool isAsidTagged() const;
+    TlbStats getStats() const;
+
+private:
+    struct Entry {
+        bool valid;
+        bool huge;
+        bool writable;
+        int asid;
+        int pageNumber;     // First page of the run for huge entries
+        int frameNumber;
+        uint64_t stamp;     // Last use (lru) or insertion (fifo)
+    };
+
+    void flush();
+    Entry* findEntry(int asid, int pageNumber, bool huge);
+    Entry* setFor(int pageNumber, bool huge);
+
+    std::mutex mutex;
+    std::vector<Entry> entries;
+    unsigned int numSets;
+    unsigned int associativity;
+    TlbReplacement replacement;
+    bool asidTagged;
+    unsigned int hugePageShift;
+    int currentAsid;
+    uint64_t clock;
+    uint32_t randomState;
+
+    // Atomic so statistics can be read without the lock
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> flushes;
+    std::atomic<uint64_t> shootdowns;
+};
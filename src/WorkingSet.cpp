@@ -0,0 +1,42 @@
+#include "WorkingSet.h"
+
+WorkingSet::WorkingSet() : window(0), next(0), pages(0), empty(true) {}
+
+void WorkingSet::setWindow(unsigned int references) {
+    window = references;
+    recent.clear();
+    recent.reserve(references);
+    next = 0;
+    counts.clear();
+    pages = 0;
+    empty = true;
+}
+
+void WorkingSet::reference(unsigned int pageNumber) {
+    if (window == 0) {
+        return;
+    }
+    if (recent.size() < window) {
+        recent.push_back(pageNumber);
+    }
+    else {
+        // The oldest reference leaves the window
+        auto it = counts.find(recent[next]);
+        if (--it->second == 0) {
+            counts.erase(it);
+        }
+        recent[next] = pageNumber;
+        next = (next + 1) % window;
+    }
+    counts[pageNumber]++;
+    pages = static_cast<unsigned int>(counts.size());
+    empty = false;
+}
+
+unsigned int WorkingSet::getPages() const {
+    return pages;
+}
+
+bool WorkingSet::isEmpty() const {
+    return empty;
+}
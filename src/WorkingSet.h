@@ -0,0 +1,31 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+// Denning working set of one process: the distinct pages among its last
+// window references, counted in the process's own references so time spent
+// waiting does not shrink it. Referenced only by the core running the
+// process; the size can be read from any thread.
+class WorkingSet {
+public:
+    WorkingSet();
+
+    // 0 stops tracking and forgets the references seen so far
+    void setWindow(unsigned int references);
+    void reference(unsigned int pageNumber);
+
+    unsigned int getPages() const;
+    // No references seen yet, so the size says nothing about the process
+    bool isEmpty() const;
+
+private:
+    unsigned int window;
+    std::vector<unsigned int> recent;   // Ring of the last window page numbers
+    size_t next;
+    std::unordered_map<unsigned int, unsigned int> counts;  // References per page inside the window
+    std::atomic<unsigned int> pages;
+    std::atomic<bool> empty;
+};
@@ -0,0 +1,20 @@
+#include "WriteCommand.h"
+#include "Process.h"
+#include "MemoryManager.h"
+#include <sstream>
+
+WriteCommand::WriteCommand(MemoryManager& memoryManager, unsigned int address, uint16_t value)
+    : memoryManager(memoryManager), address(address), value(value) {}
+
+void WriteCommand::execute(Process* process, int coreId) {
+    if (address + 1 >= process->getMemorySize()) {
+        return;
+    }
+    memoryManager.writeMemory(process, address, value, coreId);
+}
+
+std::string WriteCommand::getDescription() const {
+    std::ostringstream oss;
+    oss << "write 0x" << std::hex << std::uppercase << address << std::dec << " " << value;
+    return oss.str();
+}
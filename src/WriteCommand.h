@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Command.h"
+#include <cstdint>
+
+class MemoryManager;
+
+// WRITE address value: stores a 16-bit word in memory
+class WriteCommand : public Command {
+public:
+    WriteCommand(MemoryManager& memoryManager, unsigned int address, uint16_t value);
+    void execute(Process* process, int coreId) override;
+    std::string getDescription() const override;
+
+private:
+    MemoryManager& memoryManager;
+    unsigned int address;
+    uint16_t value;
+};